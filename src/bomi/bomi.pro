@@ -94,6 +94,8 @@ HEADERS += \
 	subtitle/richtextblock.hpp \
 	subtitle/richtextdocument.hpp \
 	subtitle/subtitledrawer.hpp \
+	subtitle/subtitleglyphs.hpp \
+	subtitle/subtiming.hpp \
 	subtitle/subtitlerenderingthread.hpp \
 	subtitle/opensubtitlesfinder.hpp \
 	quick/busyiconitem.hpp \
@@ -113,6 +115,7 @@ HEADERS += \
 	opengl/openglvertex.hpp \
 	opengl/opengltexturebase.hpp \
 	opengl/openglframebufferobject.hpp \
+	opengl/openglpixelreader.hpp \
 	opengl/opengltexture2d.hpp \
 	opengl/opengltexture1d.hpp \
 	opengl/opengltexturebinder.hpp \
@@ -219,6 +222,7 @@ HEADERS += \
     video/mpimage.hpp \
     enum/mousebehavior.hpp \
     misc/speedmeasure.hpp \
+    misc/startuptracer.hpp \
 	player/avinfoobject.hpp \
     audio/audioformat.hpp \
     player/streamtrack.hpp \
@@ -301,7 +305,12 @@ HEADERS += \
     dialog/encoderdialog.hpp \
     misc/filenamegenerator.hpp \
     enum/rotation.hpp \
-    player/videosettings.hpp
+    player/videosettings.hpp \
+    misc/mediaindex.hpp \
+    video/framestatistics.hpp \
+    video/lumaplane.hpp \
+    video/frametimings.hpp \
+    video/videoanalyzer.hpp
 
 SOURCES += \
 	stdafx.cpp \
@@ -325,6 +334,8 @@ SOURCES += \
 	subtitle/richtextblock.cpp \
 	subtitle/richtextdocument.cpp \
 	subtitle/subtitledrawer.cpp \
+	subtitle/subtitleglyphs.cpp \
+	subtitle/subtiming.cpp \
 	subtitle/subtitlerenderingthread.cpp \
 	subtitle/opensubtitlesfinder.cpp \
 	quick/geometryitem.cpp \
@@ -344,6 +355,7 @@ SOURCES += \
 	opengl/openglvertex.cpp \
 	opengl/opengltexturebase.cpp \
 	opengl/openglframebufferobject.cpp \
+	opengl/openglpixelreader.cpp \
 	opengl/opengltexture2d.cpp \
 	opengl/opengltexture1d.cpp \
 	opengl/opengltexturebinder.cpp \
@@ -445,6 +457,7 @@ SOURCES += \
     video/mpimage.cpp \
     enum/mousebehavior.cpp \
     misc/speedmeasure.cpp \
+    misc/startuptracer.cpp \
 	player/avinfoobject.cpp \
     audio/audioformat.cpp \
     player/streamtrack.cpp \
@@ -519,7 +532,12 @@ SOURCES += \
     dialog/encoderdialog.cpp \
     misc/filenamegenerator.cpp \
     enum/rotation.cpp \
-    player/videosettings.cpp
+    player/videosettings.cpp \
+    misc/mediaindex.cpp \
+    video/framestatistics.cpp \
+    video/lumaplane.cpp \
+    video/frametimings.cpp \
+    video/videoanalyzer.cpp
 
 TRANSLATIONS += translations/bomi_en.ts \
 	translations/bomi_ko.ts \
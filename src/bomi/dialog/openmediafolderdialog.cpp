@@ -2,9 +2,10 @@
 #include "ui_openmediafolderdialog.h"
 #include "player/playlist.hpp"
 #include "misc/objectstorage.hpp"
+#include "misc/mediaindex.hpp"
+#include "tmp/algorithm.hpp"
 #include <QFileIconProvider>
 #include <QCollator>
-#include "tmp/algorithm.hpp"
 
 enum ListRole {
     Type = Qt::UserRole + 1, Path
@@ -15,7 +16,11 @@ struct OpenMediaFolderDialog::Data {
     Ui::OpenMediaFolderDialog ui;
     bool generating = false;
     QFileIconProvider icons;
+    QHash<QString, QIcon> iconCache;
     ObjectStorage storage;
+    QTimer refresh;
+    QString root;
+    QCollator collator;
 
     auto updateOpenButton() -> void
     {
@@ -40,54 +45,73 @@ struct OpenMediaFolderDialog::Data {
     }
 
 
-    static auto sort(QFileInfoList &list) -> QFileInfoList&
+    auto icon(const QString &path, const QString &suffix) -> QIcon
     {
-        QCollator c;
-        c.setNumericMode(true);
-        tmp::sort(list, [&](auto &lhs, auto &rhs)
-            { return c.compare(lhs.fileName(), rhs.fileName()) < 0; });
-        return list;
+        const auto key = suffix.toLower();
+        auto it = iconCache.constFind(key);
+        if (it == iconCache.cend())
+            it = iconCache.insert(key, icons.icon(QFileInfo(path)));
+        return *it;
     }
 
-    auto open(const QDir &dir, const QString &root, bool recursive) -> void
+    // subfolders are taken from index only and filled by prefetching
+    auto open(const QString &dir, const QString &root, bool recursive,
+              const QHash<QString, Qt::CheckState> &states) -> void
     {
-        static const auto filters = _ToNameFilter(MediaExt);
-        auto files = dir.entryInfoList(filters, QDir::Files);
-        sort(files);
-        for (int i=0; i<files.size(); ++i) {
-            const auto path = files[i].absoluteFilePath();
-            auto item = new QListWidgetItem(path.mid(root.size() + 1), ui.list);
+        auto &index = MediaIndex::instance();
+        auto folder = dir == root ? index.folder(dir) : index.cached(dir);
+        // numbers in names are compared by value unlike index
+        tmp::sort(folder.entries, [&] (auto &lhs, auto &rhs)
+            { return collator.compare(lhs.name, rhs.name) < 0; });
+        tmp::sort(folder.dirs, [&] (auto &lhs, auto &rhs)
+            { return collator.compare(lhs, rhs) < 0; });
+        for (auto &entry : folder.entries) {
+            const QString suffix = entry.suffix();
             QCheckBox *box = nullptr;
-            item->setCheckState(Qt::Unchecked);
-            const QString suffix = files[i].suffix();
             if (_IsSuffixOf(VideoExt, suffix))
                 box = ui.videos;
             else if (_IsSuffixOf(AudioExt, suffix))
                 box = ui.audios;
             else if (_IsSuffixOf(ImageExt, suffix))
                 box = ui.images;
-            Q_ASSERT(box);
-            item->setIcon(icons.icon(files[i]));
+            if (!box)
+                continue;
+            const auto path = folder.filePath(entry);
+            auto item = new QListWidgetItem(path.mid(root.size() + 1), ui.list);
+            item->setCheckState(Qt::Unchecked);
+            item->setIcon(icon(path, suffix));
             item->setData(Type, QVariant::fromValue(box));
             item->setData(Path, path);
-            item->setCheckState(box->isChecked() ? Qt::Checked : Qt::Unchecked);
+            item->setCheckState(states.value(path, box->isChecked() ? Qt::Checked
+                                                                    : Qt::Unchecked));
         }
         if (recursive) {
-            auto subs = dir.entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot);
-            sort(subs);
-            for (auto &sub : subs)
-                open(QDir(sub.absoluteFilePath()), root, recursive);
+            for (auto &sub : folder.dirs)
+                open(folder.dirPath(sub), root, recursive, states);
         }
     }
 
-    auto updateList() -> void
+    auto updateList(bool keep = false) -> void
     {
+        QHash<QString, Qt::CheckState> states;
+        if (keep) {
+            for (int i = 0; i < ui.list->count(); ++i) {
+                const auto item = ui.list->item(i);
+                states.insert(item->data(Path).toString(), item->checkState());
+            }
+        }
+        generating = true;
         ui.list->clear();
         const auto folder = ui.folder->text();
+        root.clear();
         if (!folder.isEmpty()) {
-            const QDir dir(folder);
-            open(dir, dir.absolutePath(), ui.recursive->isChecked());
+            root = QDir::cleanPath(QDir(folder).absolutePath());
+            const bool recursive = ui.recursive->isChecked();
+            open(root, root, recursive, states);
+            if (recursive && !keep)
+                MediaIndex::instance().prefetch(root, true);
         }
+        generating = false;
         updateOpenButton();
     }
 };
@@ -98,6 +122,7 @@ OpenMediaFolderDialog::OpenMediaFolderDialog(QWidget *parent, const QString &key
 {
     d->p = this;
     d->ui.setupUi(this);
+    d->collator.setNumericMode(true);
     _SetWindowTitle(this, tr("Open Folder"));
 
     connect(d->ui.get, &PathButton::folderSelected, this, &OpenMediaFolderDialog::setFolder);
@@ -111,6 +136,17 @@ OpenMediaFolderDialog::OpenMediaFolderDialog(QWidget *parent, const QString &key
             this, [=] () { d->updateOpenButton(); });
     connect(d->ui.recursive, &QCheckBox::toggled, this, [=] () { d->updateList(); });
 
+    d->refresh.setSingleShot(true);
+    d->refresh.setInterval(200);
+    connect(&d->refresh, &QTimer::timeout, this, [=] () { d->updateList(true); });
+    connect(&MediaIndex::instance(), &MediaIndex::folderChanged,
+            this, [=] (const QString &path) {
+        if (d->root.isEmpty() || !d->ui.recursive->isChecked())
+            return;
+        if (path == d->root || path.startsWith(d->root % '/'_q))
+            d->refresh.start();
+    });
+
     d->ui.dbb->button(QDialogButtonBox::Open)->setEnabled(false);
     adjustSize();
 
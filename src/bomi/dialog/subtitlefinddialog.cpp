@@ -242,7 +242,8 @@ SubtitleFindDialog::SubtitleFindDialog(QWidget *parent)
     connect(&d->downloader, &Downloader::finished, [this] () {
         auto it = d->downloads.find(d->downloader.url());
         Q_ASSERT(it != d->downloads.end());
-        d->writeData(*it, _Uncompress(d->downloader.data()));
+        if (d->downloader.errorString().isEmpty())
+            d->writeData(*it, _Uncompress(d->downloader.data()));
         d->downloads.erase(it);
         d->updateState();
     });
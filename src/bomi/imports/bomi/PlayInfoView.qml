@@ -81,6 +81,14 @@ Item {
             readonly property string name: qsTr("Delayed Frames")
             content: formatBracket(name, video.delayedFrames, video.delayedTime.toFixed(3) + "ms")
         }
+        PlayInfoText {
+            readonly property string name: qsTr("Frame Timing (p50/p99 ms)")
+            content: name + ": " + Format.textNA(video.timings.text)
+        }
+        PlayInfoText {
+            readonly property string name: qsTr("Vsync Intervals")
+            content: name + ": " + Format.textNA(video.timings.lateText)
+        }
 
         Component {
             id: toolText
@@ -1,27 +1,72 @@
 #include "jrclient.hpp"
 #include "jrserver.hpp"
+#include "jriface.hpp"
 #include "http-parser/http_parser.h"
 #include "misc/log.hpp"
 #include <QNetworkRequest>
+#include <QCryptographicHash>
+#include <QAbstractSocket>
+#include <QLocalSocket>
+#include <QQueue>
 
 DECLARE_LOG_CONTEXT(JSON-RPC)
 
 struct JrClient::Data {
+    JrClient *p = nullptr;
     QIODevice *device;
     JrServer *server;
     QString peer;
+    QMap<QString, JrSubscription*> subscriptions;
+    QMap<QString, QJsonValue> sent;
+    QSet<QString> dirty;
+    QTimer timer;
+    QElapsedTimer last;
+    int interval = DefaultNotifyInterval;
+    auto schedule() -> void
+    {
+        if (timer.isActive())
+            return;
+        qint64 wait = 0;
+        if (last.isValid())
+            wait = qMax<qint64>(0, interval - last.elapsed());
+        timer.start(wait);
+    }
+    auto flush() -> void
+    {
+        QJsonObject changes;
+        for (auto &path : dirty) {
+            const auto sub = subscriptions.value(path);
+            if (!sub)
+                continue;
+            const auto value = sub->value();
+            auto it = sent.find(path);
+            if (it != sent.end() && *it == value)
+                continue;
+            changes.insert(path, value);
+            sent[path] = value;
+        }
+        dirty.clear();
+        if (changes.isEmpty())
+            return;
+        p->notify(u"changed"_q, changes);
+        last.restart();
+    }
 };
 
 JrClient::JrClient(QIODevice *device, const QString &peer, JrServer *server)
     : QObject(server), d(new Data)
 {
+    d->p = this;
     d->device = device;
     d->server = server;
     d->peer = peer;
+    d->timer.setSingleShot(true);
+    connect(&d->timer, &QTimer::timeout, this, [=] () { d->flush(); });
 }
 
 JrClient::~JrClient()
 {
+    unwatchAll();
     delete d;
 }
 
@@ -32,7 +77,7 @@ auto JrClient::peer() const -> QString
 
 auto JrClient::reply(const JrResponse &response) -> void
 {
-    write({ response }, QJsonDocument(response.toJson()));
+    write({ response }, QJsonDocument(response.toJson()).toJson(QJsonDocument::Compact));
 }
 
 auto JrClient::reply(const QList<JrResponse> &responses) -> void
@@ -40,18 +85,82 @@ auto JrClient::reply(const QList<JrResponse> &responses) -> void
     QJsonArray array;
     for (auto &res : responses)
         array.push_back(res.toJson());
-    write(responses, QJsonDocument(array));
+    write(responses, QJsonDocument(array).toJson(QJsonDocument::Compact));
 }
 
 auto JrClient::write(const QList<JrResponse> &responses,
-                     const QJsonDocument &doc) -> void
+                     const QByteArray &json) -> void
 {
-    const auto data = doc.toJson(QJsonDocument::Compact);
-    beginReply(responses, data.size() + 1);
-    *d->device << data << '\n';
+    if (!d->device->isOpen())
+        return;
+    beginReply(responses, json.size() + 1);
+    send(json);
     endReply();
-    if (autoClose())
-        d->device->close();
+}
+
+auto JrClient::send(const QByteArray &data) -> void
+{
+    *d->device << data << '\n';
+}
+
+auto JrClient::notify(const QString &method, const QJsonValue &params) -> void
+{
+    if (!isPersistent() || !d->device->isOpen())
+        return;
+    QJsonObject json;
+    json.insert(u"jsonrpc"_q, u"2.0"_q);
+    json.insert(u"method"_q, method);
+    if (!params.isUndefined())
+        json.insert(u"params"_q, params);
+    send(QJsonDocument(json).toJson(QJsonDocument::Compact));
+}
+
+auto JrClient::setNotifyInterval(int ms) -> void
+{
+    d->interval = qMax<int>(MinNotifyInterval, ms);
+}
+
+auto JrClient::watch(const QString &path, JrSubscription *sub) -> void
+{
+    unwatch(path);
+    sub->setParent(this);
+    d->subscriptions[path] = sub;
+    d->sent[path] = sub->value();
+    connect(sub, &JrSubscription::changed, this,
+            [=] () { d->dirty.insert(path); d->schedule(); });
+    connect(sub, &QObject::destroyed, this, [=] () {
+        if (d->subscriptions.value(path) == sub) {
+            d->subscriptions.remove(path);
+            d->sent.remove(path);
+            d->dirty.remove(path);
+        }
+    });
+}
+
+auto JrClient::unwatch(const QString &path) -> bool
+{
+    auto sub = d->subscriptions.take(path);
+    if (!sub)
+        return false;
+    d->sent.remove(path);
+    d->dirty.remove(path);
+    delete sub;
+    return true;
+}
+
+auto JrClient::unwatchAll() -> void
+{
+    const auto subs = d->subscriptions;
+    d->subscriptions.clear();
+    d->sent.clear();
+    d->dirty.clear();
+    d->timer.stop();
+    qDeleteAll(subs);
+}
+
+auto JrClient::watching() const -> QStringList
+{
+    return d->subscriptions.keys();
 }
 
 auto JrClient::parse(const QByteArray &data) -> void
@@ -73,13 +182,25 @@ auto JrClient::server() const -> JrServer*
 
 using Request = QNetworkRequest;
 
+// bounds of buffered input per client
+static constexpr int MaxInput = 1 << 20, MaxBody = 16 << 20, MaxPipelined = 32;
+
 struct JrHttp::Data {
     JrHttp *p = nullptr;
     http_parser *parser = nullptr;
     http_parser_settings settings;
     Request request;
-    QByteArray field, value, body;
+    QByteArray field, value, body, input;
     QString url;
+    // keep-alive flags of requests waiting for reply in order
+    QQueue<bool> keepAlive;
+    bool closing = false;
+    // WebSocket after upgrade
+    enum Opcode { Continuation = 0x0, Text = 0x1, Binary = 0x2,
+                  Close = 0x8, Ping = 0x9, Pong = 0xa };
+    static constexpr int MaxMessage = MaxBody;
+    bool websocket = false;
+    QByteArray frames, message;
     auto fillHeader() -> void
     {
         if (field.isEmpty() || value.isEmpty())
@@ -91,24 +212,169 @@ struct JrHttp::Data {
     SIA text(JrHttp::Status status) -> QByteArray
     {
         switch (status) {
+        case SwitchingProtocols: return "Switching Protocols"_b;
         case Ok: return "OK"_b;
         case BadRequest: return "Bad Request"_b;
         case NotFound: return "Not Found"_b;
         case MethodNotAllowed: return "Method Not Allowed"_b;
+        case PayloadTooLarge: return "Payload Too Large"_b;
         case InternalServerError: return "Internal Server Error"_b;
         }
         return QByteArray();
     }
     auto close(JrHttp::Status status) -> void
     {
-        writeStatus(status) << "\r\n";
-        p->device()->close();
+        writeStatus(status) << "Connection: close\r\n\r\n";
+        closeLater();
+    }
+    // closing in place may destroy client in the middle of parsing
+    auto closeLater() -> void
+    {
+        closing = true;
+        const auto device = p->device();
+        QTimer::singleShot(0, device, [device] () { device->close(); });
+    }
+    auto read() -> void
+    {
+        if (closing)
+            return;
+        if (input.size() < MaxInput)
+            input += p->device()->read(MaxInput - input.size());
+        while (!input.isEmpty() && !closing) {
+            if (websocket) {
+                frames += input;
+                input.clear();
+                readFrames();
+                return;
+            }
+            if (keepAlive.size() >= MaxPipelined)
+                return; // resumed by endReply()
+            const auto parsed = http_parser_execute(parser, &settings,
+                                                    input.constData(), input.size());
+            input.remove(0, parsed);
+            switch (HTTP_PARSER_ERRNO(parser)) {
+            case HPE_OK:
+                if (!websocket)
+                    return;
+                break;
+            case HPE_PAUSED:
+                http_parser_pause(parser, 0);
+                break;
+            default:
+                if (!closing) {
+                    _Error("Bad Request: %%", http_errno_description(HTTP_PARSER_ERRNO(parser)));
+                    close(BadRequest);
+                }
+                return;
+            }
+        }
     }
     auto writeStatus(JrHttp::Status status) -> QIODevice&
     {
         return *p->device() << "HTTP/1.1 " << QByteArray::number(status)
                             << " " << text(status) << "\r\n";
     }
+    auto upgrade() -> void
+    {
+        const auto key = request.rawHeader("Sec-WebSocket-Key").trimmed();
+        if (request.rawHeader("Upgrade").toLower() != "websocket"_b || key.isEmpty()) {
+            _Error("Bad Request: cannot upgrade to %%", request.rawHeader("Upgrade"));
+            close(BadRequest);
+            return;
+        }
+        const auto hash = QCryptographicHash::hash(key + "258EAFA5-E914-47DA-95CA-C5AB0DC85B11"_b,
+                                                   QCryptographicHash::Sha1);
+        writeStatus(SwitchingProtocols) << "Upgrade: websocket\r\n"
+                                        << "Connection: Upgrade\r\n"
+                                        << "Sec-WebSocket-Accept: " << hash.toBase64()
+                                        << "\r\n\r\n";
+        websocket = true;
+        _Info("Client upgraded to WebSocket: %%", p->peer());
+    }
+    auto writeFrame(Opcode opcode, const QByteArray &payload) -> void
+    {
+        QByteArray header;
+        header += char(0x80 | opcode);
+        const quint64 len = payload.size();
+        if (len < 126)
+            header += char(len);
+        else if (len <= 0xffff) {
+            header += char(126);
+            header += char(len >> 8);
+            header += char(len & 0xff);
+        } else {
+            header += char(127);
+            for (int i = 7; i >= 0; --i)
+                header += char((len >> (8*i)) & 0xff);
+        }
+        *p->device() << header << payload;
+    }
+    auto closeFrame(int code) -> void
+    {
+        QByteArray payload;
+        payload += char(code >> 8);
+        payload += char(code & 0xff);
+        writeFrame(Close, payload);
+        closeLater();
+    }
+    auto readFrames() -> void
+    {
+        while (frames.size() >= 2) {
+            const auto at = reinterpret_cast<const uchar*>(frames.constData());
+            const bool fin = at[0] & 0x80;
+            const int opcode = at[0] & 0x0f;
+            quint64 len = at[1] & 0x7f;
+            int header = 2;
+            if (len == 126) {
+                if (frames.size() < 4)
+                    return;
+                len = (at[2] << 8) | at[3];
+                header = 4;
+            } else if (len == 127) {
+                if (frames.size() < 10)
+                    return;
+                len = 0;
+                for (int i = 0; i < 8; ++i)
+                    len = (len << 8) | at[2 + i];
+                header = 10;
+            }
+            // frames from client must be masked
+            if (!(at[1] & 0x80) || len + message.size() > MaxMessage) {
+                _Error("Bad WebSocket frame from %%", p->peer());
+                closeFrame(1002);
+                return;
+            }
+            if ((quint64)frames.size() < header + 4 + len)
+                return;
+            const uchar *mask = at + header;
+            auto payload = frames.mid(header + 4, len);
+            for (int i = 0; i < payload.size(); ++i)
+                payload[i] = payload[i] ^ mask[i & 3];
+            frames.remove(0, header + 4 + len);
+            switch (opcode) {
+            case Continuation: case Text: case Binary:
+                message += payload;
+                if (fin) {
+                    const auto data = message;
+                    message.clear();
+                    p->parse(data);
+                }
+                break;
+            case Ping:
+                writeFrame(Pong, payload);
+                break;
+            case Pong:
+                break;
+            case Close:
+                writeFrame(Close, payload.left(2));
+                closeLater();
+                return;
+            default:
+                closeFrame(1002);
+                return;
+            }
+        }
+    }
 };
 
 JrHttp::JrHttp(QIODevice *device, const QString &peer, JrServer *server)
@@ -152,15 +418,21 @@ JrHttp::JrHttp(QIODevice *device, const QString &peer, JrServer *server)
         }
 
         const auto type = d->request.header(Request::ContentTypeHeader).toByteArray();
-        const auto len = d->request.header(Request::ContentLengthHeader).toInt();
+        const auto len = d->request.header(Request::ContentLengthHeader).toLongLong();
         const auto accept = d->request.rawHeader("Accept");
+        const bool chunked = parser->flags & F_CHUNKED;
+        if (len > MaxBody) {
+            d->close(PayloadTooLarge);
+            _Error("Payload Too Large: content-length: %%", len);
+            return -1;
+        }
 
         static const QList<QByteArray> types= {
             "application/json-rpc",
             "application/json",
             "application/jsonrequest"
         };
-        if (len <= 0 || !types.contains(type) || !types.contains(accept)) {
+        if ((len <= 0 && !chunked) || !types.contains(type) || !types.contains(accept)) {
             d->close(BadRequest);
             _Error("Bad Request: content-type: %%, content-length: %%, accept: %%", type, len, accept);
             return -1;
@@ -168,11 +440,24 @@ JrHttp::JrHttp(QIODevice *device, const QString &peer, JrServer *server)
         return 0;
     };
     d->settings.on_body = [] (http_parser *parser, const char *at, size_t len) -> int
-        { GET_DATA()->body.append(at, len); return 0; };
+    {
+        auto d = GET_DATA();
+        if (d->body.size() + (qint64)len > MaxBody) {
+            d->close(PayloadTooLarge);
+            _Error("Payload Too Large: chunked body over %% bytes", MaxBody);
+            return -1;
+        }
+        d->body.append(at, len);
+        return 0;
+    };
     d->settings.on_message_complete = [] (http_parser *parser) -> int {
         auto d = GET_DATA();
+        if (parser->upgrade) {
+            d->upgrade();
+            return 0;
+        }
         if (parser->method == HTTP_GET) {
-            QRegEx rx(uR"((\?|&)([^=]+)=([^&]+))"_q);
+            static const QRegEx rx(uR"((\?|&)([^=]+)=([^&]+))"_q);
             int pos = 0;
             d->body.clear();
             d->body += "{\"jsonrpc\":\"2.0\"";
@@ -200,14 +485,19 @@ JrHttp::JrHttp(QIODevice *device, const QString &peer, JrServer *server)
             }
             d->body += '}';
         }
+        d->keepAlive.enqueue(http_should_keep_alive(parser));
+        if (d->keepAlive.size() >= MaxPipelined)
+            http_parser_pause(parser, 1);
         d->p->parse(d->body);
         return 0;
     };
 #undef GET_DATA
-    connect(device, &QIODevice::readyRead, this, [=] () {
-        const auto data = this->device()->readAll();
-        http_parser_execute(d->parser, &d->settings, data.data(), data.size());
-    });
+    // let socket stop reading while pipelined requests are waiting
+    if (auto socket = qobject_cast<QAbstractSocket*>(device))
+        socket->setReadBufferSize(MaxInput);
+    else if (auto socket = qobject_cast<QLocalSocket*>(device))
+        socket->setReadBufferSize(MaxInput);
+    connect(device, &QIODevice::readyRead, this, [=] () { d->read(); });
 }
 
 JrHttp::~JrHttp()
@@ -216,8 +506,23 @@ JrHttp::~JrHttp()
     delete d;
 }
 
+auto JrHttp::isPersistent() const -> bool
+{
+    return d->websocket;
+}
+
+auto JrHttp::send(const QByteArray &data) -> void
+{
+    if (d->websocket)
+        d->writeFrame(Data::Text, data);
+    else
+        JrClient::send(data);
+}
+
 auto JrHttp::beginReply(const QList<JrResponse> &responses, int length) -> void
 {
+    if (d->websocket)
+        return;
     Status status = Ok;
     for (auto &res : responses) {
         switch (res.error.code) {
@@ -236,8 +541,23 @@ auto JrHttp::beginReply(const QList<JrResponse> &responses, int length) -> void
         if (status != Ok)
             break;
     }
+    const bool keepAlive = !d->keepAlive.isEmpty() && d->keepAlive.head();
     d->writeStatus(status) << "Content-Type: application/json-rpc\r\n"
-                           << "Content-Length: " << length << "\r\n\r\n";
+                           << "Content-Length: " << length << "\r\n"
+                           << "Connection: " << (keepAlive ? "keep-alive"_b : "close"_b)
+                           << "\r\n\r\n";
+}
+
+auto JrHttp::endReply() -> void
+{
+    if (d->websocket)
+        return;
+    const bool keepAlive = !d->keepAlive.isEmpty() && d->keepAlive.dequeue();
+    if (!keepAlive)
+        d->closeLater();
+    else if (d->keepAlive.size() < MaxPipelined
+             && (!d->input.isEmpty() || device()->bytesAvailable() > 0))
+        QTimer::singleShot(0, this, [=] () { d->read(); });
 }
 
 /******************************************************************************/
@@ -3,7 +3,7 @@
 
 #include "jrcommon.hpp"
 
-class JrServer;
+class JrServer;                         class JrSubscription;
 
 class JrClient : public QObject {
 public:
@@ -13,15 +13,25 @@ public:
     auto device() const -> QIODevice*;
     auto server() const -> JrServer*;
     auto parse(const QByteArray &data) -> void;
-    virtual auto autoClose() const -> bool { return false; }
+    // whether notifications can be pushed to peer
+    virtual auto isPersistent() const -> bool { return true; }
     auto reply(const JrResponse &response) -> void;
     auto reply(const QList<JrResponse> &response) -> void;
+    // json is serialized form of responses
+    auto write(const QList<JrResponse> &responses, const QByteArray &json) -> void;
+    auto notify(const QString &method, const QJsonValue &params) -> void;
+    // changes are sent as one notification at most every interval ms
+    static constexpr int DefaultNotifyInterval = 200, MinNotifyInterval = 50;
+    auto setNotifyInterval(int ms) -> void;
+    auto watch(const QString &path, JrSubscription *sub) -> void;
+    auto unwatch(const QString &path) -> bool;
+    auto unwatchAll() -> void;
+    auto watching() const -> QStringList;
 protected:
     virtual auto beginReply(const QList<JrResponse> &/*responses*/, int /*length*/) -> void { }
+    virtual auto send(const QByteArray &data) -> void;
     virtual auto endReply() -> void { }
 private:
-    auto write(const QList<JrResponse> &responses,
-               const QJsonDocument &doc) -> void;
     struct Data;
     Data *d;
 };
@@ -29,17 +39,22 @@ private:
 class JrHttp : public JrClient {
 public:
     enum Status {
+        SwitchingProtocols = 101,
         Ok = 200,
         BadRequest = 400,
         NotFound = 404,
         MethodNotAllowed = 405,
+        PayloadTooLarge = 413,
         InternalServerError = 500
     };
     JrHttp(QIODevice *device, const QString &peer, JrServer *server);
     ~JrHttp();
     auto beginReply(const QList<JrResponse> &responses, int length) -> void final;
-    auto autoClose() const -> bool final { return true; }
+    auto endReply() -> void final;
+    // notifications can be pushed once upgraded to WebSocket
+    auto isPersistent() const -> bool final;
 private:
+    auto send(const QByteArray &data) -> void final;
     struct Data;
     Data *d;
 };
@@ -1 +1,11 @@
 #include "jriface.hpp"
+
+JrSubscription::JrSubscription(QObject *object, const QMetaProperty &property,
+                               Reader &&read, QObject *parent)
+    : QObject(parent), m_read(std::move(read))
+{
+    Q_ASSERT(property.hasNotifySignal());
+    const auto changed = staticMetaObject.method(staticMetaObject.indexOfSignal("changed()"));
+    connect(object, property.notifySignal(), this, changed);
+    connect(object, &QObject::destroyed, this, &QObject::deleteLater);
+}
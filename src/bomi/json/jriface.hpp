@@ -3,11 +3,30 @@
 
 class JrRequest;                        class JrResponse;
 
+// watches a property which has notify signal on behalf of a client
+// changed() is forwarded from notify signal as is; clients coalesce it
+
+class JrSubscription : public QObject {
+    Q_OBJECT
+public:
+    using Reader = std::function<QJsonValue(void)>;
+    JrSubscription(QObject *object, const QMetaProperty &property,
+                   Reader &&read, QObject *parent = nullptr);
+    auto value() const -> QJsonValue { return m_read(); }
+signals:
+    void changed();
+private:
+    Reader m_read;
+};
+
 class JrIface : public QObject {
 public:
     JrIface(QObject *parent = nullptr): QObject(parent) { }
     ~JrIface() = default;
     virtual auto request(const JrRequest &request) -> JrResponse = 0;
+    // nullptr if path is not a property with notify signal
+    virtual auto subscribe(const QString &/*path*/,
+                           QObject */*parent*/) -> JrSubscription* { return nullptr; }
 };
 
 #endif // JRIFACE_HPP
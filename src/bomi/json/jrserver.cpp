@@ -2,6 +2,9 @@
 #include "jrclient.hpp"
 #include "jriface.hpp"
 #include "misc/log.hpp"
+#include "misc/dataevent.hpp"
+#include <QThreadPool>
+#include <QRunnable>
 #include <QTcpServer>
 #include <QTcpSocket>
 #include <QSslSocket>
@@ -12,6 +15,58 @@ DECLARE_LOG_CONTEXT(JSON-RPC)
 
 using ServerError = QAbstractSocket::SocketError;
 
+enum JrServerEvent {
+    BatchParsed = QEvent::User + 1, RepliesSerialized
+};
+
+// smaller requests are parsed in place unless others are in flight
+static constexpr int InlineParseSize = 4096;
+
+struct JrBatch {
+    QString error;
+    QList<JrRequest> requests;
+};
+
+class JrTask : public QRunnable {
+public:
+    JrTask(std::function<void(void)> &&run): m_run(std::move(run)) { }
+private:
+    auto run() -> void final { m_run(); }
+    std::function<void(void)> m_run;
+};
+
+// thread-safe
+static auto parseBatch(const QByteArray &data) -> JrBatch
+{
+    JrBatch batch;
+    QJsonParseError error = { 0, QJsonParseError::NoError };
+    auto doc = QJsonDocument::fromJson(data, &error);
+    if (error.error != QJsonParseError::NoError) {
+        batch.error = error.errorString();
+        return batch;
+    }
+    QJsonArray array;
+    if (doc.isObject())
+        array.push_back(doc.object());
+    else if (doc.isArray())
+        array = doc.array();
+    batch.requests.reserve(array.size());
+    for (int i = 0; i < array.size(); ++i)
+        batch.requests.push_back(JrRequest::fromJson(array.at(i).toObject()));
+    return batch;
+}
+
+// thread-safe
+static auto serialize(const QList<JrResponse> &responses) -> QByteArray
+{
+    if (responses.size() == 1)
+        return QJsonDocument(responses.front().toJson()).toJson(QJsonDocument::Compact);
+    QJsonArray array;
+    for (auto &res : responses)
+        array.push_back(res.toJson());
+    return QJsonDocument(array).toJson(QJsonDocument::Compact);
+}
+
 class JrTransport {
 public:
     JrTransport(JrServer *server): m_server(server) { }
@@ -107,6 +162,14 @@ struct JrServer::Data {
     QMap<QIODevice*, JrClient*> clients;
     Error handleError;
     QString errorString = u"No Error"_q;
+    // single thread keeps order of batches
+    QThreadPool pool;
+    int pending = 0;
+    auto run(std::function<void(void)> &&func) -> void
+    {
+        ++pending;
+        pool.start(new JrTask(std::move(func)));
+    }
 };
 
 JrServer::JrServer(JrConnection connection, JrProtocol protocol, QObject *parent)
@@ -114,6 +177,7 @@ JrServer::JrServer(JrConnection connection, JrProtocol protocol, QObject *parent
 {
     d->connection = connection;
     d->protocol = protocol;
+    d->pool.setMaxThreadCount(1);
     switch (d->connection) {
     case JrConnection::Tcp:
 //    case JrConnection::Ssl:
@@ -128,6 +192,8 @@ JrServer::JrServer(JrConnection connection, JrProtocol protocol, QObject *parent
 JrServer::~JrServer()
 {
     _Info("Closing server.");
+    d->pool.clear();
+    d->pool.waitForDone();
     setInterface(nullptr);
     auto devices = d->clients.keys();
     for (auto dev : devices) {
@@ -162,31 +228,36 @@ auto JrServer::listen(const QString &address, int port) -> bool
 
 auto JrServer::parse(JrClient *client, const QByteArray &data) -> void
 {
-    QJsonParseError error = { 0, QJsonParseError::NoError };
-    auto doc = QJsonDocument::fromJson(data, &error);
-    if (error.error != QJsonParseError::NoError) {
-        _Error("Cannot parse JSON: %%", error.errorString());
-        client->reply(_JrErrorResponse(QJsonValue::Null, JrError::ParseError,
-                                       error.errorString()));
+    if (!d->pending && data.size() < InlineParseSize) {
+        dispatch(client, parseBatch(data));
         return;
     }
+    QPointer<JrClient> guard = client;
+    d->run([=] () { _PostEvent(this, BatchParsed, guard, parseBatch(data)); });
+}
 
-    QJsonArray array;
-    if (doc.isObject())
-        array.push_back(doc.object());
-    else if (doc.isArray())
-        array = doc.array();
+auto JrServer::dispatch(JrClient *client, const JrBatch &batch) -> void
+{
+    if (!batch.error.isEmpty()) {
+        _Error("Cannot parse JSON: %%", batch.error);
+        client->reply(_JrErrorResponse(QJsonValue::Null, JrError::ParseError,
+                                       batch.error));
+        return;
+    }
 
     QList<JrResponse> replies;
-    replies.reserve(array.size());
-    for (int i = 0; i < array.size(); ++i) {
-        const auto request = JrRequest::fromJson(array.at(i).toObject());
+    replies.reserve(batch.requests.size());
+    for (auto &request : batch.requests) {
         if (!request.isValid()) {
             _Error("Invalid request object exits.");
             replies.push_back(_JrErrorResponse(QJsonValue::Null, JrError::InvalidRequest));
         } else {
             JrResponse res;
-            if (d->iface)
+            if (request.method() == "subscribe"_a)
+                res = subscribe(client, request);
+            else if (request.method() == "unsubscribe"_a)
+                res = unsubscribe(client, request);
+            else if (d->iface)
                 res = d->iface->request(request);
             else
                 res = _JrErrorResponse(request.id(), JrError::MethodNotFound);
@@ -194,10 +265,109 @@ auto JrServer::parse(JrClient *client, const QByteArray &data) -> void
                 replies.push_back(res);
         }
     }
-    if (replies.size() == 1)
-        client->reply(replies.front());
-    else
-        client->reply(replies);
+    if (!d->pending && replies.size() <= 1) {
+        client->write(replies, serialize(replies));
+        return;
+    }
+    QPointer<JrClient> guard = client;
+    d->run([=] () { _PostEvent(this, RepliesSerialized, guard, replies, serialize(replies)); });
+}
+
+auto JrServer::customEvent(QEvent *event) -> void
+{
+    switch ((int)event->type()) {
+    case BatchParsed: {
+        QPointer<JrClient> client; JrBatch batch;
+        _TakeData(event, client, batch);
+        --d->pending;
+        if (client)
+            dispatch(client, batch);
+        break;
+    } case RepliesSerialized: {
+        QPointer<JrClient> client; QList<JrResponse> replies; QByteArray data;
+        _TakeData(event, client, replies, data);
+        --d->pending;
+        if (client)
+            client->write(replies, data);
+        break;
+    } default:
+        break;
+    }
+}
+
+// params: [path, ...] or { "properties": [path, ...], "interval": ms }
+// result: current values of subscribed properties keyed by path
+// later changes are sent as "changed" notifications with the same form
+
+static auto subscriptionPaths(const QJsonValue &params, int *interval) -> QStringList
+{
+    QJsonArray array;
+    if (params.isArray())
+        array = params.toArray();
+    else if (params.isString())
+        array.push_back(params);
+    else if (params.isObject()) {
+        const auto json = params.toObject();
+        const auto properties = json[u"properties"_q];
+        array = properties.isString() ? QJsonArray{properties} : properties.toArray();
+        if (interval && json.contains(u"interval"_q))
+            *interval = json[u"interval"_q].toInt(*interval);
+    }
+    QStringList paths;
+    for (const auto &path : array) {
+        if (!path.isString())
+            return QStringList();
+        paths.push_back(path.toString());
+    }
+    return paths;
+}
+
+auto JrServer::subscribe(JrClient *client, const JrRequest &request) -> JrResponse
+{
+    if (!client->isPersistent())
+        return _JrErrorResponse(request.id(), JrError::InvalidRequest,
+                                u"Subscription requires persistent connection."_q);
+    int interval = -1;
+    const auto paths = subscriptionPaths(request.params(), &interval);
+    if (paths.isEmpty() || !d->iface)
+        return _JrErrorResponse(request.id(), JrError::InvalidParams);
+    QMap<QString, JrSubscription*> subs;
+    QJsonArray invalid;
+    for (auto &path : paths) {
+        if (auto sub = d->iface->subscribe(path, nullptr))
+            subs.insert(path, sub);
+        else
+            invalid.push_back(path);
+    }
+    if (!invalid.isEmpty()) {
+        qDeleteAll(subs);
+        return _JrErrorResponse(request.id(), JrError::InvalidParams,
+                                u"Not subscribable property."_q, invalid);
+    }
+    if (interval >= 0)
+        client->setNotifyInterval(interval);
+    QJsonObject values;
+    for (auto it = subs.begin(); it != subs.end(); ++it) {
+        client->watch(it.key(), *it);
+        values.insert(it.key(), (*it)->value());
+    }
+    _Debug("%% subscribed %%", client->peer(), paths.join(u", "_q));
+    return { request, values };
+}
+
+auto JrServer::unsubscribe(JrClient *client, const JrRequest &request) -> JrResponse
+{
+    if (!request.hasParams()) {
+        client->unwatchAll();
+        return { request, true };
+    }
+    const auto paths = subscriptionPaths(request.params(), nullptr);
+    if (paths.isEmpty())
+        return _JrErrorResponse(request.id(), JrError::InvalidParams);
+    bool all = true;
+    for (auto &path : paths)
+        all = client->unwatch(path) && all;
+    return { request, all };
 }
 
 auto JrServer::addClient(QIODevice *dev, const QString &peer) -> bool
@@ -224,7 +394,8 @@ auto JrServer::removeClient(QIODevice *dev) -> void
     auto client = d->clients.take(dev);
     if (client) {
         _Info("Client disconnected: %%", client->peer());
-        delete client;
+        // device can be closed while client is parsing
+        client->deleteLater();
     }
 }
 
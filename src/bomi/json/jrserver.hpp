@@ -7,6 +7,7 @@
 
 class JrIface;                          class JrClient;
 class JrRequest;                        class JrResponse;
+struct JrBatch;
 
 class JrServer : public QObject {
     Q_OBJECT
@@ -25,7 +26,12 @@ public:
 private:
     auto sendError(QAbstractSocket::SocketError error,
                    const QString &errorString) -> void;
+    auto customEvent(QEvent *event) -> void final;
+    // JSON is parsed and serialized in worker thread, invoked in this thread
     auto parse(JrClient *client, const QByteArray &data) -> void;
+    auto dispatch(JrClient *client, const JrBatch &batch) -> void;
+    auto subscribe(JrClient *client, const JrRequest &request) -> JrResponse;
+    auto unsubscribe(JrClient *client, const JrRequest &request) -> JrResponse;
     auto addClient(QIODevice *dev, const QString &peer = QString()) -> bool;
     auto removeClient(QIODevice *dev) -> void;
     friend class JrTransport;
@@ -2,6 +2,7 @@
 #include "json.hpp"
 #include "ui_autoloaderwidget.h"
 #include "simplelistmodel.hpp"
+#include "mediaindex.hpp"
 #include <QStyledItemDelegate>
 
 #define JSON_CLASS Autoloader
@@ -13,42 +14,38 @@ auto Autoloader::autoload(const Mrl &mrl, ExtType type) const -> QStringList
     if (!mrl.isLocalFile() || !enabled)
         return QStringList();
     const QFileInfo fileInfo(mrl.toLocalFile());
-    auto root = fileInfo.dir();
+    const auto root = MediaIndex::instance().folder(fileInfo.absolutePath());
     auto loaded = tryDir(fileInfo, type, root);
-    auto list = root.entryList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name);
     for (auto &path : search_paths) {
-        for (auto &one : list) {
-            if (path.match(one)) {
-                auto dir = root;
-                if (dir.cd(one))
-                    loaded += tryDir(fileInfo, type, dir);
-            }
+        for (auto &one : root.dirs) {
+            if (path.match(one))
+                loaded += tryDir(fileInfo, type, MediaIndex::instance().folder(root.dirPath(one)));
         }
     }
     return loaded;
 }
 
 auto Autoloader::tryDir(const QFileInfo &fileInfo, ExtType type,
-                        const QDir &dir) const -> QStringList
+                        const MediaFolder &dir) const -> QStringList
 {
     Q_ASSERT(enabled);
-    if (!dir.exists())
+    if (!dir.isValid())
         return QStringList();
     QStringList files;
-    const auto filter = _ToNameFilter(type);
-    const auto all = dir.entryInfoList(filter, QDir::Files, QDir::Name);
     const auto base = fileInfo.completeBaseName();
-    for (int i = 0; i < all.size(); ++i) {
-        if (all[i].fileName() == fileInfo.fileName())
+    for (auto &entry : dir.entries) {
+        if (!_IsSuffixOf(type, entry.suffix()))
+            continue;
+        if (entry.name == fileInfo.fileName())
             continue;
         if (mode != AutoloadMode::Folder) {
             if (mode == AutoloadMode::Matched) {
-                if (base != all[i].completeBaseName())
+                if (base != entry.completeBaseName())
                     continue;
-            } else if (!all[i].fileName().contains(base))
+            } else if (!entry.name.contains(base))
                 continue;
         }
-        files.push_back(all[i].absoluteFilePath());
+        files.push_back(dir.filePath(entry));
     }
     return files;
 }
@@ -1,6 +1,48 @@
 #ifndef DATAEVENT_HPP
 #define DATAEVENT_HPP
 
+// recycles memory of events with same size so that posting at high rate
+// does not go to allocator every time; events are usually created and
+// deleted in different threads so free list is guarded by mutex
+template<size_t N>
+class DataEventPool {
+public:
+    // never destroyed because events can be deleted after static destruction
+    static auto get() -> DataEventPool& { static auto pool = new DataEventPool; return *pool; }
+    auto allocate() -> void*
+    {
+        m_mutex.lock();
+        auto node = m_free;
+        if (node) {
+            m_free = node->next;
+            --m_count;
+        }
+        m_mutex.unlock();
+        return node ? node : ::operator new(N);
+    }
+    auto release(void *ptr) -> void
+    {
+        m_mutex.lock();
+        const bool keep = m_count < MaxFree;
+        if (keep) {
+            auto node = static_cast<Node*>(ptr);
+            node->next = m_free;
+            m_free = node;
+            ++m_count;
+        }
+        m_mutex.unlock();
+        if (!keep)
+            ::operator delete(ptr);
+    }
+private:
+    static_assert(N >= sizeof(void*), "too small block for free list");
+    static constexpr int MaxFree = 64;
+    struct Node { Node *next; };
+    Node *m_free = nullptr;
+    int m_count = 0;
+    QMutex m_mutex;
+};
+
 template<class... Args>
 class DataEvent : public QEvent {
 public:
@@ -16,6 +58,13 @@ public:
     template<int i>
     auto move() -> DataType<i>&& { return std::get<i>(std::move(m_data)); }
     auto tuple() const -> const Data& { return m_data; }
+    static auto operator new(size_t size) -> void*
+    {
+        Q_ASSERT(size == sizeof(DataEvent)); Q_UNUSED(size);
+        return DataEventPool<sizeof(DataEvent)>::get().allocate();
+    }
+    static auto operator delete(void *ptr) -> void
+        { DataEventPool<sizeof(DataEvent)>::get().release(ptr); }
 private:
     Data m_data;
 };
@@ -53,6 +102,36 @@ static inline T &&_MoveData(QEvent *event) {
     return static_cast<DataEvent<T>*>(event)->template move<0>();
 }
 
+// keeps only latest value for property-like data so that at most one
+// event is in flight per slot; rest of changes are merged into the value
+template<class T>
+class DataSlot {
+public:
+    // returns true if the value has to be announced with a new event
+    auto put(T &&t) -> bool
+    {
+        QMutexLocker locker(&m_mutex);
+        m_value = std::move(t);
+        return !std::exchange(m_pending, true);
+    }
+    auto take() -> T
+    {
+        QMutexLocker locker(&m_mutex);
+        m_pending = false;
+        return std::move(m_value);
+    }
+private:
+    QMutex m_mutex;
+    T m_value{};
+    bool m_pending = false;
+};
+
+template<class T>
+SIA _PostLatest(QObject *obj, int type, DataSlot<T> *slot, T t) -> void {
+    if (slot->put(std::move(t)))
+        qApp->postEvent(obj, new DataEvent<>(type));
+}
+
 using std::tie;
 
 #endif // DATAEVENT_HPP
@@ -1,7 +1,9 @@
 #include "downloader.hpp"
 #include "misc/log.hpp"
+#include "misc/speedmeasure.hpp"
 #include <QQuickItem>
 #include <QNetworkReply>
+#include <QTemporaryFile>
 
 DECLARE_LOG_CONTEXT(Downloader)
 
@@ -22,16 +24,134 @@ static auto sufficesForMimeType(const QString &type) -> QStringList
     return mime.suffixes();
 }
 
+static constexpr int MaxRetries = 5;
+
+static auto isResumable(QNetworkReply::NetworkError error) -> bool
+{
+    switch (error) {
+    case QNetworkReply::RemoteHostClosedError:
+    case QNetworkReply::TimeoutError:
+    case QNetworkReply::TemporaryNetworkFailureError:
+    case QNetworkReply::NetworkSessionFailedError:
+    case QNetworkReply::ProxyConnectionClosedError:
+    case QNetworkReply::UnknownNetworkError:
+        return true;
+    default:
+        return false;
+    }
+}
+
 struct Downloader::Data {
     Downloader *p = nullptr;
     QUrl url;
     QNetworkAccessManager *nam = nullptr;
     bool running = false, canceled = false;
-    QByteArray data;
     qint64 written = -1, total = -1;
     qreal rate = -1.0;
     QNetworkReply *reply = nullptr;
     QStringList suffices;
+    // received data goes to sink as it arrives, temporary file by default
+    QIODevice *sink = nullptr, *userSink = nullptr;
+    QTemporaryFile *spool = nullptr;
+    // bytes in sink and at which current request has started
+    qint64 stored = 0, offset = 0;
+    bool checked = false;
+    int retries = 0;
+    QByteArray validator;
+    QString error;
+    SpeedMeasure<qint64> speed{3, 20};
+
+    auto get() -> void
+    {
+        QNetworkRequest request(url);
+        offset = stored;
+        checked = false;
+        if (offset > 0) {
+            request.setRawHeader("Range", "bytes=" + QByteArray::number(offset) + '-');
+            // server sends whole body again if resource has been changed
+            if (!validator.isEmpty())
+                request.setRawHeader("If-Range", validator);
+        }
+        reply = nam->get(request);
+        connect(reply, &QNetworkReply::downloadProgress, p, [=] (qint64 r, qint64 t)
+            { p->progress(offset + r, t < 0 ? -1 : offset + t); });
+        connect(reply, &QNetworkReply::readyRead, p, [=] () { receive(); });
+        connect(reply, &QNetworkReply::finished, p, [=] () { finish(); });
+    }
+    auto rewind() -> bool
+    {
+        stored = offset = 0;
+        speed.reset();
+        if (spool)
+            return spool->resize(0) && spool->seek(0);
+        return !sink->isSequential() && sink->seek(0);
+    }
+    // returns false if download has been stopped by error
+    auto receive() -> bool
+    {
+        if (!checked) {
+            checked = true;
+            const auto status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+            if (offset > 0 && status != 206) {
+                _Info("Server ignored range request. Download from the beginning.");
+                if (!rewind()) {
+                    done(u"Cannot rewind sink to download again."_q);
+                    return false;
+                }
+            }
+            if (offset == 0) {
+                validator = reply->rawHeader("ETag");
+                if (validator.isEmpty())
+                    validator = reply->rawHeader("Last-Modified");
+            }
+        }
+        const auto chunk = reply->readAll();
+        if (chunk.isEmpty())
+            return true;
+        if (sink->write(chunk) != chunk.size()) {
+            done(u"Cannot write downloaded data: "_q % sink->errorString());
+            return false;
+        }
+        stored += chunk.size();
+        speed.push(stored);
+        return true;
+    }
+    auto finish() -> void
+    {
+        if (!receive())
+            return;
+        const auto error = reply->error();
+        if (suffices.isEmpty())
+            suffices = sufficesForMimeType(reply->header(QNetworkRequest::ContentTypeHeader).toString());
+        if (!canceled && isResumable(error) && retries < MaxRetries) {
+            reply->deleteLater();
+            reply = nullptr;
+            ++retries;
+            _Warn("Connection dropped after %% bytes. Try to resume (%%/%%).",
+                  stored, retries, MaxRetries);
+            get();
+            return;
+        }
+        done(error == QNetworkReply::NoError ? QString() : reply->errorString());
+    }
+    // error is empty if succeeded
+    auto done(const QString &error) -> void
+    {
+        if (reply) {
+            reply->disconnect(p);
+            if (reply->isRunning())
+                reply->abort();
+            reply->deleteLater();
+            reply = nullptr;
+        }
+        this->error = error;
+        if (!error.isEmpty() && !canceled)
+            _Error("Failed to download %%: %%", url, error);
+        running = false;
+        emit p->speedChanged();
+        emit p->finished();
+        emit p->runningChanged();
+    }
 };
 
 Downloader::Downloader(QObject *parent)
@@ -40,12 +160,14 @@ Downloader::Downloader(QObject *parent)
 {
     d->p = this;
     d->nam = new QNetworkAccessManager;
+    d->speed.setTimer([=] () { emit speedChanged(); }, 500000);
 }
 
 Downloader::~Downloader()
 {
     if (d->reply)
         cancel();
+    delete d->spool;
     delete d->nam;
     delete d;
 }
@@ -123,24 +245,29 @@ auto Downloader::start(const QUrl &url, const QStringList &extFilter) -> bool
             return false;
     }
 
+    _Delete(d->spool);
+    d->sink = d->userSink;
+    if (!d->sink) {
+        d->spool = new QTemporaryFile;
+        if (!d->spool->open()) {
+            _Error("Cannot create temporary file to download %%.", url);
+            _Delete(d->spool);
+            return false;
+        }
+        d->sink = d->spool;
+    }
+    d->stored = 0;
+    d->retries = 0;
+    d->validator.clear();
+    d->error.clear();
+    d->speed.reset();
+
     d->running = true;
     emit started();
     emit runningChanged();
     progress(-1, -1);
-
-    d->reply = d->nam->get(QNetworkRequest(url));
-    connect(d->reply, &QNetworkReply::downloadProgress,
-            this, &Downloader::progress);
-    connect(d->reply, &QNetworkReply::finished, [this] () {
-        d->data = d->reply->readAll();
-        if (d->suffices.isEmpty())
-            d->suffices = sufficesForMimeType(d->reply->header(QNetworkRequest::ContentTypeHeader).toString());
-        d->running = false;
-        emit finished();
-        emit runningChanged();
-        d->reply->deleteLater();
-        d->reply = nullptr;
-    });
+    emit speedChanged();
+    d->get();
     return true;
 }
 
@@ -173,14 +300,31 @@ auto Downloader::rate() const -> qreal
     return d->rate;
 }
 
+auto Downloader::speed() const -> qreal
+{
+    return d->speed.get();
+}
+
+auto Downloader::setSink(QIODevice *sink) -> void
+{
+    d->userSink = sink;
+}
+
 auto Downloader::takeData() -> QByteArray
 {
-    auto data = d->data;
-    d->data = QByteArray();
+    auto data = this->data();
+    _Delete(d->spool);
     return data;
 }
 
+auto Downloader::errorString() const -> QString
+{
+    return d->error;
+}
+
 auto Downloader::data() const -> QByteArray
 {
-    return d->data;
+    if (!d->spool || d->running || !d->error.isEmpty() || !d->spool->seek(0))
+        return QByteArray();
+    return d->spool->readAll();
 }
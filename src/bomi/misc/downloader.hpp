@@ -8,27 +8,38 @@ class Downloader: public QObject {
     Q_PROPERTY(qint64 totalSize READ totalSize NOTIFY totalSizeChanged)
     Q_PROPERTY(qint64 writtenSize READ writtenSize NOTIFY writtenSizeChanged)
     Q_PROPERTY(qreal rate READ rate NOTIFY rateChanged)
+    Q_PROPERTY(qreal speed READ speed NOTIFY speedChanged)
     Q_PROPERTY(QUrl url READ url NOTIFY urlChanged)
 public:
     Downloader(QObject *parent = nullptr);
     ~Downloader();
     auto type(const QUrl &url, int timeout = 30000) -> QString;
+    // interrupted transfer is resumed with range request
     auto start(const QUrl &url, const QStringList &extFilter = QStringList()) -> bool;
+    // data is written to sink while downloading instead of temporary file
+    // sink has to be opened for writing and stays owned by caller
+    auto setSink(QIODevice *sink) -> void;
     auto suffixes() const -> QStringList;
     auto isRunning() const -> bool;
+    // read back from temporary file; empty if sink is set or failed
     auto data() const -> QByteArray;
     auto takeData() -> QByteArray;
     auto url() const -> QUrl;
     auto totalSize() const -> qint64;
     auto writtenSize() const -> qint64;
     auto rate() const -> qreal;
+    // bytes per second
+    auto speed() const -> qreal;
     auto isCanceled() const -> bool;
+    // empty if download has succeeded or is running
+    auto errorString() const -> QString;
     Q_INVOKABLE void cancel();
 signals:
     void writtenSizeChanged(qint64 writtenSize);
     void totalSizeChanged(qint64 totalSize);
     void progressed(qint64 written, qint64 total);
     void rateChanged();
+    void speedChanged();
     void runningChanged();
     void finished();
     void started();
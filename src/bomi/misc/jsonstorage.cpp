@@ -174,6 +174,19 @@ static auto convs() -> const QHash<int, JVConvert>&
         INSERT(WindowSize);
         INSERT(QList<WindowSize>);
 
+        // plain maps, e.g., reports for JSON-RPC
+        c[QMetaType::QVariantMap] = {
+            [] (const JVConvert*, const QJsonValue &j, QVariant &var) -> bool {
+                if (!j.isObject())
+                    return false;
+                var = j.toObject().toVariantMap();
+                return true;
+            },
+            [] (const JVConvert*, const QVariant &v) -> QJsonValue {
+                return QJsonObject::fromVariantMap(v.toMap());
+            }, QVariantMap(), QJsonValue::Object, {}, QMetaType::QVariantMap
+        };
+
         for (auto type : _EnumMetaTypeIds()) {
             auto &ec = c[type];
             ec.enum_ = _EnumNameVariantConverter(type);
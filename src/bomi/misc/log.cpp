@@ -5,7 +5,9 @@
 #include "tmp/algorithm.hpp"
 #include <QTextCodec>
 #include <QBuffer>
+#include <QThread>
 #include <cstdlib>
+#include <atomic>
 
 #if HAVE_SYSTEMD
 #include <syslog.h>
@@ -50,32 +52,204 @@ const QStringList Log::m_options = QStringList()
 
 SIA print(FILE *file, const QByteArray &log) -> void
 {
+    if (log.isEmpty())
+        return;
     fwrite(log.constData(), 1, log.size(), file);
     fflush(file);
 }
 
-auto Log::print(Level lv, const QByteArray &log) -> void
-{
+struct LogBatch {
+    QByteArray stdOut, stdErr, file;
+    Log::Lines viewer;
+    auto add(Log::Level lv, const QByteArray &log) -> void
+    {
 #if HAVE_SYSTEMD
-    if (lv <= lvJournal)
-        sd_journal_print(jp[lv], log.constData());
+        if (lv <= lvJournal)
+            sd_journal_print(jp[lv], "%s", log.constData());
 #endif
-    if (lv <= lvStdOut)
-        ::print(stdout, encodeForTerminal(log));
-    if (lv <= lvStdErr)
-        ::print(stderr, encodeForTerminal(log));
-    if (lv <= lvFile && s_file)
-        ::print(s_file.data(), log);
-    if (lv <= lvViewer && !s_subscribers.isEmpty()) {
-        s_rwLock.lockForRead();
-        auto &s = _C(s_subscribers);
-        auto str = QString::fromUtf8(log); str.chop(1);
-        for (auto it = s.begin(); it != s.end(); ++it)
-            _PostEvent(it.key(), it.value(), lv, str);
-        s_rwLock.unlock();
+        if (lv <= lvStdOut)
+            stdOut += log;
+        if (lv <= lvStdErr)
+            stdErr += log;
+        if (lv <= lvFile && s_file)
+            file += log;
+        if (lv <= lvViewer && !s_subscribers.isEmpty()) {
+            auto str = QString::fromUtf8(log); str.chop(1);
+            viewer.push_back({ lv, str });
+        }
+    }
+    auto flush() -> void
+    {
+        ::print(stdout, encodeForTerminal(stdOut));
+        ::print(stderr, encodeForTerminal(stdErr));
+        if (s_file)
+            ::print(s_file.data(), file);
+        if (!viewer.isEmpty()) {
+            s_rwLock.lockForRead();
+            auto &s = _C(s_subscribers);
+            for (auto it = s.begin(); it != s.end(); ++it)
+                _PostEvent(it.key(), it.value(), viewer);
+            s_rwLock.unlock();
+        }
+        stdOut.clear(); stdErr.clear(); file.clear(); viewer.clear();
+    }
+};
+
+/******************************************************************************/
+
+// bounded MPSC ring from which LogWriter takes lines in batches
+// producers never wait for consumer; lines are dropped and counted when full
+
+static constexpr int RingSize = 4096, MaxBatch = 512;
+
+struct LogSlot {
+    std::atomic<quint64> seq{0};
+    Log::Level level = Log::Off;
+    QByteArray log;
+};
+
+static std::array<LogSlot, RingSize> s_ring;
+static std::atomic<quint64> s_head{0}, s_done{0};
+static quint64 s_tail = 0; // writer only
+static std::atomic<quint32> s_dropped{0};
+static std::atomic<bool> s_running{false}, s_sleeping{false};
+static QMutex s_wakeMutex;
+static QWaitCondition s_wake;
+
+// returns position of line or -1 if dropped
+static auto push(Log::Level lv, const QByteArray &log) -> qint64
+{
+    auto pos = s_head.load(std::memory_order_relaxed);
+    for (;;) {
+        auto &slot = s_ring[pos & (RingSize - 1)];
+        const auto seq = slot.seq.load(std::memory_order_acquire);
+        const auto diff = (qint64)(seq - pos);
+        if (diff == 0) {
+            if (s_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                slot.level = lv;
+                slot.log = log;
+                slot.seq.store(pos + 1, std::memory_order_release);
+                return pos;
+            }
+        } else if (diff < 0) {
+            s_dropped.fetch_add(1, std::memory_order_relaxed);
+            return -1;
+        } else
+            pos = s_head.load(std::memory_order_relaxed);
+    }
+}
+
+static auto pop(Log::Level &lv, QByteArray &log) -> bool
+{
+    auto &slot = s_ring[s_tail & (RingSize - 1)];
+    if (slot.seq.load(std::memory_order_acquire) != s_tail + 1)
+        return false;
+    lv = slot.level;
+    log = std::move(slot.log);
+    slot.log = QByteArray();
+    slot.seq.store(s_tail + RingSize, std::memory_order_release);
+    ++s_tail;
+    return true;
+}
+
+static auto wake() -> void
+{
+    if (s_sleeping.load(std::memory_order_acquire)) {
+        QMutexLocker locker(&s_wakeMutex);
+        s_wake.wakeOne();
+    }
+}
+
+// returns true if any line has been written
+static auto drain(LogBatch &batch) -> bool
+{
+    Log::Level lv; QByteArray log; int count = 0;
+    while (count < MaxBatch && pop(lv, log)) {
+        batch.add(lv, log);
+        ++count;
+    }
+    if (const auto dropped = s_dropped.exchange(0, std::memory_order_relaxed)) {
+        batch.add(Log::Warn, "(W)[Log] "_b + QByteArray::number(dropped)
+                  + " lines dropped by overload\n"_b);
+        ++count;
     }
-    if (lv == Fatal)
+    if (!count)
+        return false;
+    batch.flush();
+    s_done.store(s_tail, std::memory_order_release);
+    return true;
+}
+
+class LogWriter : public QThread {
+    auto run() -> void final
+    {
+        LogBatch batch;
+        for (;;) {
+            if (drain(batch))
+                continue;
+            if (!s_running.load(std::memory_order_acquire))
+                break;
+            QMutexLocker locker(&s_wakeMutex);
+            s_sleeping.store(true, std::memory_order_release);
+            const auto &next = s_ring[s_tail & (RingSize - 1)];
+            if (next.seq.load(std::memory_order_acquire) != s_tail + 1)
+                s_wake.wait(&s_wakeMutex, 100);
+            s_sleeping.store(false, std::memory_order_release);
+        }
+    }
+};
+
+static LogWriter *s_writer = nullptr;
+
+static auto stopWriter() -> void
+{
+    if (!s_writer)
+        return;
+    s_running.store(false, std::memory_order_release);
+    {
+        QMutexLocker locker(&s_wakeMutex);
+        s_wake.wakeOne();
+    }
+    s_writer->wait();
+    delete s_writer;
+    s_writer = nullptr;
+    LogBatch batch;
+    while (drain(batch)) { }
+}
+
+static auto startWriter() -> void
+{
+    if (s_writer)
+        return;
+    for (int i = 0; i < RingSize; ++i)
+        s_ring[i].seq.store(i, std::memory_order_relaxed);
+    s_head.store(0);
+    s_tail = 0;
+    s_running.store(true, std::memory_order_release);
+    s_writer = new LogWriter;
+    s_writer->start();
+    std::atexit(stopWriter);
+}
+
+auto Log::print(Level lv, const QByteArray &log) -> void
+{
+    if (!s_running.load(std::memory_order_acquire)) {
+        LogBatch batch;
+        batch.add(lv, log);
+        batch.flush();
+        if (lv == Fatal)
+            abort();
+        return;
+    }
+    const auto pos = push(lv, log);
+    wake();
+    if (lv == Fatal) {
+        // give writer a chance to print the reason
+        for (int i = 0; i < 1000 && pos >= 0
+             && s_done.load(std::memory_order_acquire) <= (quint64)pos; ++i)
+            QThread::msleep(1);
         abort();
+    }
 }
 
 static const std::array<Log::Level, 4> lvQt = []() {
@@ -94,6 +268,14 @@ auto Log::qt(QtMsgType type, const QMessageLogContext &, const QString &msg) ->
 
 static LogOption s_option;
 
+auto Log::buffer() -> QByteArray&
+{
+    static thread_local QByteArray buffer;
+    if (!buffer.capacity())
+        buffer.reserve(256);
+    return buffer;
+}
+
 auto Log::setOption(const LogOption &option) -> void
 {
     s_option = option;
@@ -110,15 +292,15 @@ auto Log::setOption(const LogOption &option) -> void
 
     s_local8BitIsUtf8 = QTextCodec::codecForLocale()->mibEnum() == 106;
 
-    if (!lvFile)
-        return;
-    auto path = option.file().toLocal8Bit();
-    auto pf = fopen(path.constData(), "a");
-    if (!pf) {
-        qDebug("Cannot open file: %s\n", path.constData());
-        return;
+    if (lvFile) {
+        auto path = option.file().toLocal8Bit();
+        auto pf = fopen(path.constData(), "a");
+        if (pf)
+            s_file = QSharedPointer<FILE>(pf, fclose);
+        else
+            qDebug("Cannot open file: %s\n", path.constData());
     }
-    s_file = QSharedPointer<FILE>(pf, fclose);
+    startWriter();
 }
 
 auto Log::option() -> const LogOption&
@@ -54,10 +54,80 @@ SIA _ToLog(const QList<T> &list) -> QByteArray
 }
 auto _ToLog(const QVariant &var) -> QByteArray;
 
+// append without temporary for common types, fallback to _ToLog()
+template<class T>
+SIA _AppendLog(QByteArray &log, const T &t) -> void { log += _ToLog(t); }
+template<class T>
+SIA _AppendLogInteger(QByteArray &log, T n) -> void
+{
+    char buf[24]; char *const end = buf + sizeof(buf); char *p = end;
+    const bool negative = n < 0;
+    auto u = negative ? 0ull - (unsigned long long)n : (unsigned long long)n;
+    do { *--p = '0' + u % 10; u /= 10; } while (u);
+    if (negative)
+        *--p = '-';
+    log.append(p, end - p);
+}
+SIA _AppendLog(QByteArray &log, char n) -> void { _AppendLogInteger(log, n); }
+SIA _AppendLog(QByteArray &log, signed char n) -> void { _AppendLogInteger(log, n); }
+SIA _AppendLog(QByteArray &log, short n) -> void { _AppendLogInteger(log, n); }
+SIA _AppendLog(QByteArray &log, int n) -> void { _AppendLogInteger(log, n); }
+SIA _AppendLog(QByteArray &log, long n) -> void { _AppendLogInteger(log, n); }
+SIA _AppendLog(QByteArray &log, long long n) -> void { _AppendLogInteger(log, n); }
+SIA _AppendLog(QByteArray &log, unsigned char n) -> void { _AppendLogInteger(log, n); }
+SIA _AppendLog(QByteArray &log, unsigned short n) -> void { _AppendLogInteger(log, n); }
+SIA _AppendLog(QByteArray &log, unsigned int n) -> void { _AppendLogInteger(log, n); }
+SIA _AppendLog(QByteArray &log, unsigned long n) -> void { _AppendLogInteger(log, n); }
+SIA _AppendLog(QByteArray &log, unsigned long long n) -> void { _AppendLogInteger(log, n); }
+SIA _AppendLog(QByteArray &log, const QChar *str, int len) -> void
+{
+    // encode utf-8 in place; a QChar takes 3 bytes at most
+    const int from = log.size();
+    log.resize(from + len * 3);
+    auto p = reinterpret_cast<uchar*>(log.data() + from);
+    for (int i = 0; i < len; ++i) {
+        uint c = str[i].unicode();
+        if (c < 0x80) {
+            *p++ = c;
+            continue;
+        }
+        if (c < 0x800) {
+            *p++ = 0xc0 | (c >> 6);
+            *p++ = 0x80 | (c & 0x3f);
+            continue;
+        }
+        if (QChar::isSurrogate(c)) {
+            const uint low = i + 1 < len ? str[i + 1].unicode() : 0u;
+            if (!QChar::isHighSurrogate(c) || !QChar::isLowSurrogate(low)) {
+                *p++ = '?';
+                continue;
+            }
+            c = QChar::surrogateToUcs4(c, low);
+            ++i;
+            *p++ = 0xf0 | (c >> 18);
+            *p++ = 0x80 | ((c >> 12) & 0x3f);
+        } else
+            *p++ = 0xe0 | (c >> 12);
+        *p++ = 0x80 | ((c >> 6) & 0x3f);
+        *p++ = 0x80 | (c & 0x3f);
+    }
+    log.resize(reinterpret_cast<char*>(p) - log.data());
+}
+SIA _AppendLog(QByteArray &log, const QString &str) -> void
+    { _AppendLog(log, str.constData(), str.size()); }
+SIA _AppendLog(QByteArray &log, const QStringRef &str) -> void
+    { _AppendLog(log, str.constData(), str.size()); }
+SIA _AppendLog(QByteArray &log, const char *str) -> void { log += str; }
+SIA _AppendLog(QByteArray &log, const QByteArray &str) -> void { log += str; }
+SIA _AppendLog(QByteArray &log, bool b) -> void { log += b ? "true" : "false"; }
+
 class Log {
     constexpr static const char *l2t = " FEWIDT";
 public:
     enum Level { Off, Fatal, Error, Warn, Info, Debug, Trace };
+    // delivered to subscribers in batches
+    struct Line { Level level; QString text; };
+    using Lines = QVector<Line>;
     template<class F>
     static auto write(Level level, F &&getLogText) -> void
     {
@@ -77,6 +147,34 @@ public:
     template<class... Args>
     static auto parse(const QByteArray &fmt, const Args &... args) -> QByteArray
         { return std::move(Helper(fmt, args...).log()); }
+    // positions of placeholders in a string literal found at compile time
+    template<int N>
+    struct Format {
+        constexpr Format(const char (&str)[N]): str(str)
+        {
+            for (int i = 0; i + 1 < N - 1; ++i) {
+                if (str[i] == '%' && str[i + 1] == '%')
+                    at[count++] = i++;
+            }
+        }
+        constexpr auto begin(int i) const -> int { return i ? at[i - 1] + 2 : 0; }
+        const char *str = nullptr;
+        int count = 0;
+        int at[N/2 + 1] = {};
+    };
+    template<int Count, int N, class... Args>
+    static auto format(Level lv, const char *ctx, const Format<N> &f,
+                       const Args &... args) -> QByteArray
+    {
+        static_assert(Count == sizeof...(Args),
+                      "number of placeholders and arguments mismatch");
+        auto &log = buffer();
+        log.resize(0);
+        ((((log += '(') += l2t[lv]) += ")[") += ctx) += "] ";
+        append(log, f, 0, args...);
+        log += '\n';
+        return QByteArray(log.constData(), log.size());
+    }
     static auto name(Level level) -> QString { return m_options[level]; }
     static auto levelNames() -> QStringList { return m_options; }
     static auto level(const QString &name) -> Level
@@ -84,6 +182,7 @@ public:
         const int index = m_options.indexOf(name);
         return index < 0 ? Off : (Level)index;
     }
+    // queued for writer thread once setOption() is called; dropped if queue is full
     static auto print(Level lv, const QByteArray &log) -> void;
     static auto maximumLevel() -> Level;
     static auto setOption(const LogOption &option) -> void;
@@ -92,6 +191,19 @@ public:
     static auto subscribe(QObject *o, int event) -> int;
     static auto unsubscribe(QObject *o) -> void;
 private:
+    // thread-local buffer which keeps its capacity
+    static auto buffer() -> QByteArray&;
+    template<int N>
+    static auto append(QByteArray &log, const Format<N> &f, int i) -> void
+        { log.append(f.str + f.begin(i), N - 1 - f.begin(i)); }
+    template<int N, class T, class... Args>
+    static auto append(QByteArray &log, const Format<N> &f, int i,
+                       const T &t, const Args &... args) -> void
+    {
+        log.append(f.str + f.begin(i), f.at[i] - f.begin(i));
+        _AppendLog(log, t);
+        append(log, f, i + 1, args...);
+    }
     struct Helper {
         template<class... Args>
         inline Helper(const QByteArray &format, const Args &... args)
@@ -151,8 +263,12 @@ private:
 #define DECLARE_LOG_CONTEXT(ctx) \
     static inline const char *getLogContext() { return (#ctx); }
 
-#define _WriteLog(lv, fmt, ...) Log::write(lv, [&] () \
-    { return std::move(Log::parse(lv, getLogContext(), fmt, ##__VA_ARGS__)); })
+// fmt should be a string literal which is parsed at compile time
+// invoked in place to be usable as an expression, e.g., in MPV_CHECK()
+#define _WriteLog(lv, fmt, ...) ([&] () -> void { if (lv <= Log::maximumLevel()) { \
+    static constexpr Log::Format<sizeof(fmt)> _format(fmt); \
+    Log::print(lv, Log::format<_format.count>(lv, getLogContext(), _format, ##__VA_ARGS__)); \
+    } } ())
 #define _Fatal(fmt, ...) _WriteLog(Log::Fatal, fmt, ##__VA_ARGS__)
 #define _Error(fmt, ...) _WriteLog(Log::Error, fmt, ##__VA_ARGS__)
 #define _Warn(fmt, ...)  _WriteLog(Log::Warn,  fmt, ##__VA_ARGS__)
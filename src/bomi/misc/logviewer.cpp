@@ -215,24 +215,38 @@ auto LogViewer::customEvent(QEvent *ev) -> void
         return;
     if (d->stop)
         return;
-    LogEntry entry;
-    _TakeData(ev, entry.level, entry.message);
-    Q_ASSERT(entry.message.at(3) == '['_q);
-    const int idx = entry.message.indexOf(']'_q, 4);
-    if (idx < 0) {
-        qDebug("Unknown logging context. Skip it.");
-        return;
+    Log::Lines lines;
+    _TakeData(ev, lines);
+    QList<LogEntry> entries;
+    entries.reserve(lines.size());
+    bool newContext = false;
+    for (auto &line : lines) {
+        LogEntry entry;
+        entry.level = line.level;
+        entry.message = std::move(line.text);
+        Q_ASSERT(entry.message.at(3) == '['_q);
+        const int idx = entry.message.indexOf(']'_q, 4);
+        if (idx < 0) {
+            qDebug("Unknown logging context. Skip it.");
+            continue;
+        }
+        entry.context = entry.message.mid(4, idx -4 );
+        if (d->newContext(entry.context, true))
+            newContext = true;
+        entries.push_back(entry);
     }
-    entry.context = entry.message.mid(4, idx -4 );
-    d->model.append(entry);
+    if (entries.isEmpty())
+        return;
+    d->model.append(entries);
 
-    if (d->newContext(entry.context, true)) {
+    if (newContext) {
         d->ui.context->sortItems();
         d->syncContext();
     }
 
-    if (d->model.rows() > d->lines)
-        d->model.remove(0);
+    const int excess = d->model.rows() - d->lines;
+    if (excess > 0)
+        d->model.remove(0, excess);
     if (d->ui.autoscroll->isChecked())
         d->ui.view->scrollToBottom();
 }
@@ -0,0 +1,413 @@
+#include "mediaindex.hpp"
+#include "dataevent.hpp"
+#include "log.hpp"
+#include "tmp/algorithm.hpp"
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QFileSystemWatcher>
+#include <QThreadPool>
+#include <QRunnable>
+
+DECLARE_LOG_CONTEXT(MediaIndex)
+
+enum MediaIndexEvent {
+    FolderScanned = QEvent::User + 1, WatchFolder
+};
+
+static constexpr int Version = 2;
+// keep inotify usage reasonable on huge trees
+static constexpr int MaxWatches = 4096;
+
+auto MediaFolder::files(ExtTypes exts) const -> QStringList
+{
+    QStringList list;
+    for (auto &entry : entries) {
+        if (!exts || _IsSuffixOf(exts, entry.suffix()))
+            list.push_back(filePath(entry));
+    }
+    return list;
+}
+
+SIA cleanPath(const QString &path) -> QString
+{
+    auto clean = QDir::cleanPath(QDir(path).absolutePath());
+    if (clean.size() > 1 && clean.endsWith('/'_q))
+        clean.chop(1);
+    return clean;
+}
+
+static auto scan(const QString &path) -> MediaFolder
+{
+    MediaFolder folder;
+    folder.path = path;
+    const QDir dir(path);
+    folder.mtime = MediaIndex::mtime(QFileInfo(path));
+    if (folder.mtime < 0)
+        return folder;
+    const auto infos = dir.entryInfoList(QDir::Files | QDir::Dirs
+                                         | QDir::NoDotAndDotDot, QDir::NoSort);
+    folder.entries.reserve(infos.size());
+    for (auto &info : infos) {
+        if (info.isDir())
+            folder.dirs.push_back(info.fileName());
+        else {
+            MediaIndexEntry entry;
+            entry.name = info.fileName();
+            entry.size = info.size();
+            entry.mtime = MediaIndex::mtime(info);
+            folder.entries.push_back(entry);
+        }
+    }
+    // same order as QDir::Name
+    tmp::sort(folder.entries, [] (auto &lhs, auto &rhs)
+        { return lhs.name < rhs.name; });
+    tmp::sort(folder.dirs);
+    return folder;
+}
+
+class FolderScanner : public QRunnable {
+public:
+    FolderScanner(QObject *index, const QString &path, bool recursive)
+        : m_index(index), m_path(path), m_recursive(recursive) { }
+private:
+    auto run() -> void final
+        { _PostEvent(m_index, FolderScanned, scan(m_path), m_recursive); }
+    QObject *m_index = nullptr;
+    const QString m_path;
+    const bool m_recursive = false;
+};
+
+// owns the connection so that all sql runs in one thread
+// reading blocks the caller and goes ahead of queued writing
+class MediaIndexDatabase : public QThread {
+public:
+    MediaIndexDatabase() { start(QThread::LowPriority); }
+    ~MediaIndexDatabase()
+    {
+        m_mutex.lock();
+        m_quit = true;
+        m_mutex.unlock();
+        m_wake.wakeAll();
+        wait();
+    }
+    auto load(const QString &path) -> MediaFolder
+    {
+        MediaFolder folder;
+        bool done = false;
+        post(true, [&] () {
+            folder = select(path);
+            QMutexLocker locker(&m_mutex);
+            done = true;
+            m_done.wakeAll();
+        });
+        QMutexLocker locker(&m_mutex);
+        while (!done)
+            m_done.wait(&m_mutex);
+        return folder;
+    }
+    auto store(const MediaFolder &folder) -> void
+        { post(false, [=] () { insert(folder); }); }
+private:
+    auto post(bool urgent, std::function<void(void)> &&job) -> void
+    {
+        m_mutex.lock();
+        if (urgent)
+            m_jobs.push_front(std::move(job));
+        else
+            m_jobs.push_back(std::move(job));
+        m_mutex.unlock();
+        m_wake.wakeAll();
+    }
+    auto run() -> void final
+    {
+        open();
+        QMutexLocker locker(&m_mutex);
+        for (;;) {
+            while (m_jobs.isEmpty() && !m_quit)
+                m_wake.wait(&m_mutex);
+            if (m_jobs.isEmpty())
+                break;
+            const auto job = m_jobs.takeFirst();
+            locker.unlock();
+            job();
+            locker.relock();
+        }
+        locker.unlock();
+        m_query = QSqlQuery();
+        m_db.close();
+        m_db = QSqlDatabase();
+        QSqlDatabase::removeDatabase(u"media-index"_q);
+    }
+    auto check(bool ok) -> bool
+    {
+        if (!ok)
+            _Error("Error on query: %% for %%",
+                   m_query.lastError().text(), m_query.lastQuery());
+        return ok;
+    }
+    auto open() -> bool
+    {
+        m_db = QSqlDatabase::addDatabase(u"QSQLITE"_q, u"media-index"_q);
+        m_db.setDatabaseName(_WritablePath(Location::Cache) % "/media-index.db"_a);
+        if (!m_db.open()) {
+            _Error("Error: %%. Couldn't create database.",
+                   m_db.lastError().text());
+            return false;
+        }
+        m_query = QSqlQuery(m_db);
+        m_query.exec(u"PRAGMA journal_mode = WAL"_q);
+        m_query.exec(u"PRAGMA synchronous = NORMAL"_q);
+        m_query.exec(u"PRAGMA user_version"_q);
+        int version = 0;
+        if (m_query.next())
+            version = m_query.value(0).toInt();
+        if (version != Version) {
+            m_db.transaction();
+            m_query.exec(u"DROP TABLE IF EXISTS folder"_q);
+            m_query.exec(u"DROP TABLE IF EXISTS file"_q);
+            check(m_query.exec(u"CREATE TABLE folder (path TEXT PRIMARY KEY"
+                               ", mtime INTEGER, dirs TEXT)"_q));
+            check(m_query.exec(u"CREATE TABLE file (path TEXT PRIMARY KEY"
+                               ", folder TEXT, name TEXT, pos INTEGER"
+                               ", size INTEGER, mtime INTEGER)"_q));
+            check(m_query.exec(u"CREATE INDEX file_folder ON file (folder, pos)"_q));
+            m_db.commit();
+            m_query.exec(u"PRAGMA user_version = "_q % _N(Version));
+        }
+        return true;
+    }
+    auto select(const QString &path) -> MediaFolder
+    {
+        MediaFolder folder;
+        folder.path = path;
+        if (!m_db.isOpen())
+            return folder;
+        m_query.prepare(u"SELECT mtime, dirs FROM folder WHERE path = ?"_q);
+        m_query.addBindValue(path);
+        if (!check(m_query.exec()) || !m_query.next())
+            return folder;
+        folder.mtime = m_query.value(0).toLongLong();
+        const auto dirs = m_query.value(1).toString();
+        if (!dirs.isEmpty())
+            folder.dirs = dirs.split('/'_q);
+        m_query.prepare(u"SELECT name, size, mtime FROM file "
+                        "WHERE folder = ? ORDER BY pos"_q);
+        m_query.addBindValue(path);
+        if (!check(m_query.exec()))
+            return MediaFolder();
+        while (m_query.next()) {
+            MediaIndexEntry entry;
+            entry.name = m_query.value(0).toString();
+            entry.size = m_query.value(1).toLongLong();
+            entry.mtime = m_query.value(2).toLongLong();
+            folder.entries.push_back(entry);
+        }
+        return folder;
+    }
+    auto insert(const MediaFolder &folder) -> void
+    {
+        if (!m_db.isOpen())
+            return;
+        m_db.transaction();
+        m_query.prepare(u"DELETE FROM file WHERE folder = ?"_q);
+        m_query.addBindValue(folder.path);
+        check(m_query.exec());
+        if (folder.isValid()) {
+            m_query.prepare(u"INSERT OR REPLACE INTO folder (path, mtime, dirs) "
+                            "VALUES (?, ?, ?)"_q);
+            m_query.addBindValue(folder.path);
+            m_query.addBindValue(folder.mtime);
+            m_query.addBindValue(folder.dirs.join('/'_q));
+            check(m_query.exec());
+            m_query.prepare(u"INSERT OR REPLACE INTO file "
+                            "(path, folder, name, pos, size, mtime) "
+                            "VALUES (?, ?, ?, ?, ?, ?)"_q);
+            for (int i = 0; i < folder.entries.size(); ++i) {
+                auto &entry = folder.entries[i];
+                m_query.addBindValue(folder.filePath(entry));
+                m_query.addBindValue(folder.path);
+                m_query.addBindValue(entry.name);
+                m_query.addBindValue(i);
+                m_query.addBindValue(entry.size);
+                m_query.addBindValue(entry.mtime);
+                check(m_query.exec());
+            }
+        } else {
+            m_query.prepare(u"DELETE FROM folder WHERE path = ?"_q);
+            m_query.addBindValue(folder.path);
+            check(m_query.exec());
+        }
+        if (!m_db.commit())
+            m_db.rollback();
+    }
+    QMutex m_mutex;
+    QWaitCondition m_wake, m_done;
+    QList<std::function<void(void)>> m_jobs;
+    bool m_quit = false;
+    QSqlDatabase m_db;
+    QSqlQuery m_query;
+};
+
+struct MediaIndex::Data {
+    MediaIndexDatabase db;
+    QHash<QString, MediaFolder> folders;
+    QSet<QString> dirty, pending, watched;
+    QFileSystemWatcher watcher;
+    QThreadPool pool;
+    QMutex mutex;
+
+    // mutex should be locked
+    auto remember(const MediaFolder &folder) -> void
+    {
+        folders[folder.path] = folder;
+        dirty.remove(folder.path);
+    }
+    // mutex should be locked; unlocked while loading from database
+    auto find(const QString &path, QMutexLocker &locker) -> QHash<QString, MediaFolder>::iterator
+    {
+        auto it = folders.find(path);
+        if (it != folders.end())
+            return it;
+        locker.unlock();
+        const auto folder = db.load(path);
+        locker.relock();
+        it = folders.find(path);
+        if (it == folders.end())
+            it = folders.insert(path, folder);
+        return it;
+    }
+    auto watch(const QString &path) -> void
+    {
+        QMutexLocker locker(&mutex);
+        if (watched.size() < MaxWatches && !watched.contains(path)) {
+            watched.insert(path);
+            watcher.addPath(path);
+        }
+    }
+};
+
+MediaIndex::MediaIndex()
+    : d(new Data)
+{
+    d->pool.setMaxThreadCount(qBound(2, QThread::idealThreadCount(), 4));
+    connect(&d->watcher, &QFileSystemWatcher::directoryChanged,
+            this, [=] (const QString &path) {
+        {
+            QMutexLocker locker(&d->mutex);
+            d->dirty.insert(path);
+        }
+        prefetch(path, false);
+    });
+}
+
+MediaIndex::~MediaIndex()
+{
+    d->pool.clear();
+    d->pool.waitForDone();
+    delete d;
+}
+
+static MediaIndex *obj = nullptr;
+
+auto MediaIndex::initialize() -> void
+{
+    Q_ASSERT(QThread::currentThread() == qApp->thread());
+    if (!obj)
+        obj = new MediaIndex;
+}
+
+auto MediaIndex::instance() -> MediaIndex&
+{
+    Q_ASSERT(obj);
+    return *obj;
+}
+
+auto MediaIndex::finalize() -> void
+{
+    _Delete(obj);
+}
+
+auto MediaIndex::folder(const QString &dir) -> MediaFolder
+{
+    const auto path = cleanPath(dir);
+    QMutexLocker locker(&d->mutex);
+    auto it = d->find(path, locker);
+    const bool watched = d->watched.contains(path);
+    if (it->isValid() && watched && !d->dirty.contains(path))
+        return *it;
+    // one stat() instead of a whole listing when the cache is still fresh
+    const auto mtime = MediaIndex::mtime(QFileInfo(path));
+    if (it->isValid() && it->mtime == mtime) {
+        d->dirty.remove(path);
+        if (!watched)
+            _PostEvent(this, WatchFolder, path);
+        return *it;
+    }
+    locker.unlock();
+    const auto scanned = scan(path);
+    locker.relock();
+    d->remember(scanned);
+    d->db.store(scanned);
+    if (scanned.isValid())
+        _PostEvent(this, WatchFolder, path);
+    return scanned;
+}
+
+auto MediaIndex::cached(const QString &dir) -> MediaFolder
+{
+    const auto path = cleanPath(dir);
+    QMutexLocker locker(&d->mutex);
+    return *d->find(path, locker);
+}
+
+auto MediaIndex::prefetch(const QString &dir, bool recursive) -> void
+{
+    const auto path = cleanPath(dir);
+    QMutexLocker locker(&d->mutex);
+    if (d->pending.contains(path))
+        return;
+    d->pending.insert(path);
+    d->pool.start(new FolderScanner(this, path, recursive));
+}
+
+auto MediaIndex::customEvent(QEvent *event) -> void
+{
+    switch ((int)event->type()) {
+    case FolderScanned: {
+        MediaFolder folder; bool recursive = false;
+        _TakeData(event, folder, recursive);
+        QStringList subs; bool changed = false;
+        {
+            QMutexLocker locker(&d->mutex);
+            d->pending.remove(folder.path);
+            const auto it = d->folders.constFind(folder.path);
+            changed = it == d->folders.cend() || it->mtime != folder.mtime
+                    || it->entries != folder.entries || it->dirs != folder.dirs;
+            d->remember(folder);
+            d->db.store(folder);
+            if (recursive) {
+                for (auto &name : folder.dirs) {
+                    const auto sub = folder.dirPath(name);
+                    const auto it = d->folders.constFind(sub);
+                    // unwatched folder may have changed while not running
+                    if (changed || it == d->folders.cend() || d->dirty.contains(sub)
+                            || !d->watched.contains(sub))
+                        subs.push_back(sub);
+                }
+            }
+        }
+        if (folder.isValid())
+            d->watch(folder.path);
+        for (auto &sub : subs)
+            prefetch(sub, true);
+        if (changed)
+            emit folderChanged(folder.path);
+        break;
+    } case WatchFolder:
+        d->watch(_GetData<QString>(event));
+        break;
+    default:
+        break;
+    }
+}
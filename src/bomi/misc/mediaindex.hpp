@@ -0,0 +1,57 @@
+#ifndef MEDIAINDEX_HPP
+#define MEDIAINDEX_HPP
+
+struct MediaIndexEntry {
+    DECL_EQ(MediaIndexEntry, &T::name, &T::size, &T::mtime)
+    auto suffix() const -> QString
+        { const int idx = name.lastIndexOf('.'_q); return idx < 0 ? QString() : name.mid(idx + 1); }
+    auto completeBaseName() const -> QString
+        { const int idx = name.lastIndexOf('.'_q); return idx < 0 ? name : name.left(idx); }
+    QString name;
+    qint64 size = 0, mtime = 0;
+};
+
+struct MediaFolder {
+    auto isValid() const -> bool { return mtime >= 0; }
+    auto filePath(const MediaIndexEntry &entry) const -> QString
+        { return path % '/'_q % entry.name; }
+    auto dirPath(const QString &name) const -> QString
+        { return path % '/'_q % name; }
+    // absolute paths in name order as QDir::Name
+    auto files(ExtTypes exts) const -> QStringList;
+    QString path;
+    qint64 mtime = -1;
+    QVector<MediaIndexEntry> entries;
+    QStringList dirs;
+};
+
+class MediaIndex : public QObject {
+    Q_OBJECT
+public:
+    ~MediaIndex();
+    // -1 if file does not exist
+    static auto mtime(const QFileInfo &info) -> qint64
+        { return info.exists() ? info.lastModified().toMSecsSinceEpoch() : -1; }
+    // should be called in GUI thread which delivers watcher events
+    static auto initialize() -> void;
+    static auto instance() -> MediaIndex&;
+    static auto finalize() -> void;
+    // callable in any thread; sql runs in database thread of the index
+    // hits the filesystem only if the folder is unknown or stale
+    auto folder(const QString &path) -> MediaFolder;
+    auto files(const QString &path, ExtTypes exts) -> QStringList
+        { return folder(path).files(exts); }
+    // never hits the filesystem; invalid if the folder is unknown
+    auto cached(const QString &path) -> MediaFolder;
+    // scan in background and emit folderChanged() for changed folders
+    auto prefetch(const QString &path, bool recursive) -> void;
+signals:
+    void folderChanged(const QString &path);
+private:
+    MediaIndex();
+    auto customEvent(QEvent *event) -> void final;
+    struct Data;
+    Data *d;
+};
+
+#endif // MEDIAINDEX_HPP
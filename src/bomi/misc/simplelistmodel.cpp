@@ -322,6 +322,15 @@ auto SimpleListModelBase::remove(int row) -> bool
     return isValidRow(row) ? removeRow(row) : false;
 }
 
+auto SimpleListModelBase::remove(int row, int count) -> int
+{
+    count = qMin(count, rows() - row);
+    if (!isValidRow(row) || count <= 0)
+        return 0;
+    removeRows(row, count, QModelIndex());
+    return count;
+}
+
 auto SimpleListModelBase::remove(const QModelIndexList &indices) -> int
 {
     std::set<int> set;
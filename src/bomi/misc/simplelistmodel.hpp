@@ -23,6 +23,8 @@ public:
     auto checkedList(int column) const -> QVector<bool>;
     auto isChecked(int row, int column) const -> bool;
     auto remove(int row) -> bool;
+    // removes valid rows among count rows from row
+    auto remove(int row, int count) -> int;
     auto remove(const QModelIndexList &indices) -> int;
     auto swap(int r1, int r2) -> bool;
     auto clear() -> void;
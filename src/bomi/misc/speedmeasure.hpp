@@ -3,13 +3,14 @@
 
 #include <QElapsedTimer>
 #include <functional>
-#include <deque>
+#include <vector>
+#include <algorithm>
 
+// rate over the last max records kept in fixed-capacity ring
+// so that push() never allocates or shifts memory on hot paths
 template<class T>
 class SpeedMeasure {
     struct Record {
-        Record(quint64 time, const T &value)
-            : value(value), usec(time) { }
         T value = 0;
         quint64 usec = 0;
     };
@@ -19,15 +20,25 @@ public:
         setDequeSize(min, max);
         m_watch.start();
     }
-    auto reset() -> void { m_records.clear(); m_last = 0; }
+    auto reset() -> void { m_head = m_size = 0; m_last = 0; m_ewma = 0.0; }
     auto get() const -> double
-        { return ((int)m_records.size() < m_min) ? 0.0 : dvalue()/dsec(); }
+        { return (m_size < m_min) ? 0.0 : dvalue()/dsec(); }
     auto push(const T &t) -> void
+        { push(t, m_watch.nsecsElapsed() * 1e-3); }
+    // for given timestamp, e.g., to replay recorded samples
+    auto push(const T &t, quint64 usec) -> void
     {
-        const quint64 usec = m_watch.nsecsElapsed() * 1e-3;
-        m_records.emplace_back(usec, t);
-        while ((int)m_records.size() > m_max)
-            m_records.pop_front();
+        if (m_size > 0 && m_alpha > 0.0 && usec > back().usec) {
+            const double rate = (t - back().value) / ((usec - back().usec) * 1e-6);
+            m_ewma = m_size > 1 ? m_alpha * rate + (1.0 - m_alpha) * m_ewma : rate;
+        }
+        if (m_size < m_max)
+            ++m_size;
+        else
+            m_head = next(m_head);
+        auto &record = at(m_size - 1);
+        record.value = t;
+        record.usec = usec;
         if (m_interval > 0 && m_timer) {
             if (!m_last || m_last > usec ) {
                 m_last = usec;
@@ -37,27 +48,55 @@ public:
             }
         }
     }
-    auto count() const -> int { return m_records.size(); }
+    auto count() const -> int { return m_size; }
     auto setDequeSize(int min, int max) -> void
     {
         Q_ASSERT(min > 1 && min <= max);
+        std::vector<Record> records(max);
+        const int size = std::min(m_size, max);
+        for (int i = 0; i < size; ++i)
+            records[i] = at(m_size - size + i);
+        m_records.swap(records);
+        m_intervals.resize(max);
+        m_head = 0;
+        m_size = size;
         m_min = min;
         m_max = max;
-        while ((int)m_records.size() > m_max)
-            m_records.pop_front();
     }
-    auto dusec() const -> quint64
-        { return m_records.back().usec - m_records.front().usec; }
+    auto dusec() const -> quint64 { return back().usec - front().usec; }
     auto dsec() const -> double { return dusec() * 1e-6; }
-    auto dvalue() const -> T
-        { return m_records.back().value - m_records.front().value; }
+    auto dvalue() const -> T { return back().value - front().value; }
     auto setTimer(std::function<void(void)> &&timer,
                   quint64 usec = 5000000) -> void
         { m_timer = std::move(timer); m_interval = usec; }
+    // 0 < alpha <= 1 for weight of latest rate, 0 to disable
+    auto setSmoothing(double alpha) -> void { m_alpha = alpha; }
+    // exponentially weighted rate between consecutive records
+    auto smoothed() const -> double { return m_size < m_min ? 0.0 : m_ewma; }
+    // usecs between consecutive records at given percentile in [0, 1]
+    auto interval(double percentile) const -> quint64
+    {
+        const int n = m_size - 1;
+        if (n < 1)
+            return 0;
+        for (int i = 0; i < n; ++i)
+            m_intervals[i] = at(i + 1).usec - at(i).usec;
+        const int k = qBound(0, qRound(percentile * (n - 1)), n - 1);
+        std::nth_element(m_intervals.begin(), m_intervals.begin() + k,
+                         m_intervals.begin() + n);
+        return m_intervals[k];
+    }
 private:
-    std::deque<Record> m_records;
-    int m_min = 2, m_max = 20;
+    auto next(int i) const -> int { return ++i < m_max ? i : 0; }
+    auto at(int i) const -> const Record& { return m_records[(m_head + i) % m_max]; }
+    auto at(int i) -> Record& { return m_records[(m_head + i) % m_max]; }
+    auto front() const -> const Record& { return at(0); }
+    auto back() const -> const Record& { return at(m_size - 1); }
+    std::vector<Record> m_records;
+    mutable std::vector<quint64> m_intervals;
+    int m_min = 2, m_max = 20, m_head = 0, m_size = 0;
     quint64 m_last = 0, m_interval = 0;
+    double m_alpha = 0.0, m_ewma = 0.0;
     std::function<void(void)> m_timer;
     QElapsedTimer m_watch;
 };
@@ -0,0 +1,97 @@
+#include "startuptracer.hpp"
+#include "log.hpp"
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QElapsedTimer>
+
+DECLARE_LOG_CONTEXT(Startup)
+
+struct Event {
+    const char *name = nullptr;
+    qint64 begin = 0, end = -1; // end < 0 for instant event
+    bool main = true;
+};
+
+// started in static initialization, i.e., before main()
+static const QElapsedTimer s_timer = [] () { QElapsedTimer t; t.start(); return t; }();
+static QMutex s_mutex;
+static QVector<Event> s_events;
+static bool s_finished = false;
+
+auto StartupTracer::now() -> qint64
+{
+    return s_timer.nsecsElapsed() / 1000;
+}
+
+auto StartupTracer::add(const char *name, qint64 begin, qint64 end) -> void
+{
+    const bool main = !qApp || QThread::currentThread() == qApp->thread();
+    QMutexLocker locker(&s_mutex);
+    if (!s_finished)
+        s_events.push_back({ name, begin, end, main });
+}
+
+auto StartupTracer::isFinished() -> bool
+{
+    QMutexLocker locker(&s_mutex);
+    return s_finished;
+}
+
+auto StartupTracer::toJson() -> QByteArray
+{
+    QMutexLocker locker(&s_mutex);
+    QJsonArray events;
+    for (auto &e : s_events) {
+        QJsonObject obj;
+        obj[u"name"_q] = QString::fromLatin1(e.name);
+        obj[u"ts"_q] = e.begin;
+        obj[u"pid"_q] = 1;
+        obj[u"tid"_q] = e.main ? 1 : 2;
+        if (e.end < 0) {
+            obj[u"ph"_q] = u"i"_q;
+            obj[u"s"_q] = u"g"_q;
+        } else {
+            obj[u"ph"_q] = u"X"_q;
+            obj[u"dur"_q] = e.end - e.begin;
+        }
+        events.push_back(obj);
+    }
+    QJsonObject root;
+    root[u"traceEvents"_q] = events;
+    root[u"displayTimeUnit"_q] = u"ms"_q;
+    return QJsonDocument(root).toJson(QJsonDocument::Compact);
+}
+
+auto StartupTracer::finish(qint64 firstFrame) -> void
+{
+    if (isFinished())
+        return;
+    add("first frame", firstFrame, -1);
+    const auto json = toJson();
+    {
+        QMutexLocker locker(&s_mutex);
+        s_finished = true;
+        s_events.clear();
+        s_events.squeeze();
+    }
+    const double ms = firstFrame * 1e-3;
+    _Info("First frame presented in %%ms.", ms);
+
+    const auto path = QString::fromLocal8Bit(qgetenv("BOMI_STARTUP_TRACE"));
+    if (!path.isEmpty()) {
+        QFile file(path);
+        if (file.open(QFile::WriteOnly | QFile::Truncate))
+            file.write(json);
+        else
+            _Error("Cannot write startup trace to '%%'.", path);
+    }
+
+    bool ok = false;
+    const int budget = qgetenv("BOMI_STARTUP_BUDGET").toInt(&ok);
+    if (ok) {
+        if (ms > budget)
+            _Error("First frame exceeded budget of %%ms.", budget);
+        qApp->exit(ms > budget);
+    }
+}
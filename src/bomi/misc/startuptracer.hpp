@@ -0,0 +1,30 @@
+#ifndef STARTUPTRACER_HPP
+#define STARTUPTRACER_HPP
+
+// records monotonic timestamps of startup phases until the first frame
+// BOMI_STARTUP_TRACE=<file> dumps them as Chrome trace JSON (chrome://tracing)
+// BOMI_STARTUP_BUDGET=<ms> quits after the first frame with exit code 1
+// if the first frame took longer than the budget, otherwise with 0
+
+class StartupTracer {
+public:
+    class Scope {
+    public:
+        Scope(const char *name): m_name(name), m_begin(now()) { }
+        ~Scope() { add(m_name, m_begin, now()); }
+    private:
+        const char *m_name = nullptr;
+        qint64 m_begin = 0;
+    };
+    // usecs since the process started; thread-safe
+    static auto now() -> qint64;
+    // thread-safe; ignored after finish()
+    static auto add(const char *name, qint64 begin, qint64 end) -> void;
+    static auto mark(const char *name) -> void { add(name, now(), -1); }
+    // call in main thread when the first frame has been presented
+    static auto finish(qint64 firstFrame) -> void;
+    static auto isFinished() -> bool;
+    static auto toJson() -> QByteArray;
+};
+
+#endif // STARTUPTRACER_HPP
@@ -25,12 +25,98 @@
  */
 #include "udf25.hpp"
 #include "misc/log.hpp"
+#include <QCache>
 #include <stdio.h>
 #include <stdlib.h>
 #include <fcntl.h>
 
 DECLARE_LOG_CONTEXT(UDF)
 
+namespace udf {
+
+// reads image in chunks of 32 blocks kept in LRU cache
+// sequential misses read ahead several chunks in a single request
+// mmap is not used since I/O error of network storage would raise SIGBUS
+
+class Image {
+public:
+  static constexpr qint64 ChunkSize = 32 * DVD_VIDEO_LB_LEN;
+  static constexpr int MaxChunks = 256, ReadAhead = 4;
+  auto open(const QString &path) -> bool
+  {
+    m_file.setFileName(path);
+    if (!m_file.open(QFile::ReadOnly | QFile::Unbuffered))
+      return false;
+    const QFileInfo info(path);
+    m_key = info.absoluteFilePath() % '|'_q % _N(info.size())
+            % '|'_q % _N(info.lastModified().toMSecsSinceEpoch());
+    return true;
+  }
+  // identifies path and revision of image
+  auto key() const -> QString { return m_key; }
+  auto read(qint64 pos, qint64 len, uchar *data) -> qint64
+  {
+    qint64 done = 0;
+    while (done < len) {
+      const qint64 index = (pos + done) / ChunkSize;
+      const qint64 offset = (pos + done) % ChunkSize;
+      const auto c = chunk(index);
+      if (!c || c->size() <= offset)
+        break;
+      const auto n = qMin<qint64>(c->size() - offset, len - done);
+      memcpy(data + done, c->constData() + offset, n);
+      done += n;
+    }
+    return done;
+  }
+private:
+  auto chunk(qint64 index) -> const QByteArray*
+  {
+    if (auto c = m_chunks.object(index)) {
+      m_last = index;
+      return c;
+    }
+    const int count = index == m_last + 1 ? ReadAhead : 1;
+    if (!m_file.seek(index * ChunkSize))
+      return nullptr;
+    const auto data = m_file.read(count * ChunkSize);
+    for (int i = 0; i < count && i * ChunkSize < data.size(); ++i)
+      m_chunks.insert(index + i, new QByteArray(data.mid(i * ChunkSize, ChunkSize)));
+    m_last = index;
+    return m_chunks.object(index);
+  }
+  QFile m_file;
+  QString m_key;
+  QCache<qint64, QByteArray> m_chunks{MaxChunks};
+  qint64 m_last = -2;
+};
+
+// files and directories resolved in an image, shared in process
+// nullptr file means it does not exist
+
+struct ImageIndex {
+  QHash<QString, QSharedPointer<FileAD>> files;
+  QHash<QString, QStringList> dirs;
+};
+
+static constexpr int MaxIndices = 16;
+static QMutex s_indexMutex;
+static QHash<QString, QSharedPointer<ImageIndex>> s_indices;
+
+static auto imageIndex(const QString &key) -> QSharedPointer<ImageIndex>
+{
+  QMutexLocker locker(&s_indexMutex);
+  auto it = s_indices.find(key);
+  if (it == s_indices.end()) {
+    if (s_indices.size() >= MaxIndices)
+      s_indices.clear();
+    it = s_indices.insert(key, QSharedPointer<ImageIndex>::create());
+  }
+  return *it;
+}
+
+}
+
 /* For direct data access, LSB first */
 #define GETN1(p) ((quint8)data[p])
 #define GETN2(p) ((quint16)data[p] | ((quint16)data[(p) + 1] << 8))
@@ -591,11 +677,10 @@ auto udf25::GetUDFCache(UDFCacheType type, quint32 nr, void *data) -> int
 
 auto udf25::ReadAt( int64_t pos, size_t len, unsigned char *data ) -> int
 {
-  if (!m_fp->seekg(pos))
-    return -1;
-  if (!m_fp->read((char*)data, len))
+  const auto read = m_image->read(pos, len, data);
+  if ((size_t)read < len)
     _Error("ReadFile - less data than requested available!");
-  return m_fp->gcount();
+  return read;
 }
 
 auto udf25::DVDReadLBUDF( quint32 lb_number, size_t block_count, unsigned char *data, int /*encrypted*/ ) -> int
@@ -956,14 +1041,14 @@ auto udf25::UDFScanDir( struct FileAD Dir, char *FileName, struct Partition *par
 
 udf25::udf25( )
 {
-  m_fp = NULL;
+  m_image = NULL;
   m_udfcache_level = 1;
   m_udfcache = NULL;
 }
 
 udf25::~udf25( )
 {
-  delete m_fp;
+  delete m_image;
   free(m_udfcache);
 }
 
@@ -1056,18 +1141,50 @@ auto udf25::UDFFindFile( const char* filename, quint64 *filesize ) -> FileAD*
 
 auto udf25::Open(const char *isofile) -> bool
 {
-  m_fp = new std::fstream(isofile, std::ios::binary | std::ios::in);
+  m_image = new Image;
 
-  if(!m_fp->is_open())
+  if(!m_image->open(QString::fromLocal8Bit(isofile)))
   {
     _Error("file_open - Could not open input");
-    delete m_fp;
-    m_fp = NULL;
+    delete m_image;
+    m_image = NULL;
     return false;
   }
+  m_index = imageIndex(m_image->key());
   return true;
 }
 
+auto udf25::FindFile( const QString &filename, quint64 *filesize ) -> FileAD*
+{
+  QSharedPointer<FileAD> file;
+  {
+    QMutexLocker locker(&s_indexMutex);
+    auto it = m_index->files.constFind(filename);
+    if (it != m_index->files.cend()) {
+      file = *it;
+      if (!file) {
+        *filesize = 0;
+        return NULL;
+      }
+    }
+  }
+  if (!file) {
+    auto found = UDFFindFile(filename.toLocal8Bit(), filesize);
+    if (found) {
+      file.reset(new FileAD);
+      memcpy(file.data(), found, sizeof(FileAD));
+    }
+    QMutexLocker locker(&s_indexMutex);
+    m_index->files.insert(filename, file);
+    return found;
+  }
+  *filesize = file->Length;
+  auto result = (struct FileAD *) malloc(sizeof(FileAD));
+  if (result)
+    memcpy(result, file.data(), sizeof(FileAD));
+  return result;
+}
+
 
 
 //int64_t udf25::GetFileSize(HANDLE hFile)
@@ -1094,8 +1211,8 @@ auto udf25::Open(const char *isofile) -> bool
 
 
 File::File(udf25 *udf, const QString &fileName): m_udf(udf) {
-    if (udf->m_fp)
-        m_file = udf->UDFFindFile(fileName.toLocal8Bit(), &m_size);
+    if (udf->m_image)
+        m_file = udf->FindFile(fileName, &m_size);
 }
 
 File::~File() {
@@ -1179,6 +1296,17 @@ auto File::seek(int64_t offset, int whence) -> int64_t
 }
 
 Dir::Dir(udf25 *udf, const QString &path): m_udf(udf), m_path(path) {
+    if (!udf->m_image)
+        return;
+    {
+        QMutexLocker locker(&s_indexMutex);
+        auto it = udf->m_index->dirs.constFind(path);
+        if (it != udf->m_index->dirs.cend()) {
+            m_files = *it;
+            m_open = true;
+            return;
+        }
+    }
     File file(udf, path);
     if (!file.isOpen())
       return;
@@ -1204,6 +1332,8 @@ Dir::Dir(udf25 *udf, const QString &path): m_udf(udf), m_path(path) {
             continue;
         m_files.append(file);
     }
+    QMutexLocker locker(&s_indexMutex);
+    udf->m_index->dirs.insert(path, m_files);
 }
 
 auto Dir::files(bool withPath) const -> QStringList
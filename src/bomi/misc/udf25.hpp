@@ -26,8 +26,6 @@
  *
  */
 
-#include <fstream>
-
 namespace udf {
 
 /**
@@ -172,6 +170,7 @@ struct udf_dir_t {
 };
 
 class File;        class Dir;
+class Image;       struct ImageIndex;
 
 class udf25
 {
@@ -181,6 +180,8 @@ public:
   ~udf25( );
   auto Open(const char *isofile) -> bool;
 private:
+  // looks up files resolved before by any reader of the same image first
+  FileAD *FindFile( const QString &filename, quint64 *filesize );
   FileAD *UDFFindFile( const char* filename, quint64 *filesize );
   auto UDFScanDirX( udf_dir_t *dirp ) -> int;
   auto DVDUDFCacheLevel(int level) -> int;
@@ -200,7 +201,8 @@ protected:
     /* Filesystem cache */
   int m_udfcache_level; /* 0 - turned off, 1 - on */
   void *m_udfcache;
-  std::fstream *m_fp;
+  Image *m_image;
+  QSharedPointer<ImageIndex> m_index;
 };
 
 
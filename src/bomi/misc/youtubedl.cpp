@@ -5,6 +5,9 @@
 #include <QTemporaryDir>
 #include <QTemporaryFile>
 #include <QProcess>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QCryptographicHash>
 
 DECLARE_LOG_CONTEXT(YouTubeDL)
 
@@ -105,6 +108,72 @@ auto YouTubeFormat::isLive() const -> bool
 
 /******************************************************************************/
 
+// resolved formats expire quickly because urls are signed with expiry
+static constexpr qint64 CacheExpiry = 60 * 60 * 1000;
+static constexpr int MaxResolvers = 2;
+
+struct YouTubeCache {
+    QJsonObject json;
+    QByteArray cookies;
+    qint64 time = 0;
+    auto isValid() const -> bool
+    {
+        const auto now = QDateTime::currentMSecsSinceEpoch();
+        return !json.isEmpty() && time <= now && now - time < CacheExpiry;
+    }
+};
+
+static auto cacheKey(const QString &url) -> QString
+{
+    const auto hash = QCryptographicHash::hash(url.toUtf8(), QCryptographicHash::Sha1);
+    return QString::fromLatin1(hash.toHex());
+}
+
+static auto cachePath(const QString &url) -> QString
+{
+    static const auto dir = [] () {
+        const auto path = _WritablePath(Location::Cache) % "/youtube-dl"_a;
+        QDir().mkpath(path);
+        return path;
+    }();
+    return dir % '/'_q % cacheKey(url) % ".json"_a;
+}
+
+// thread-safe
+static auto readCache(const QString &url) -> YouTubeCache
+{
+    YouTubeCache cache;
+    QFile file(cachePath(url));
+    if (!file.open(QFile::ReadOnly))
+        return cache;
+    const auto json = QJsonDocument::fromJson(file.readAll()).object();
+    if (json[u"url"_q].toString() != url)
+        return cache;
+    cache.json = json[u"json"_q].toObject();
+    cache.cookies = QByteArray::fromBase64(json[u"cookies"_q].toString().toLatin1());
+    cache.time = json[u"time"_q].toDouble();
+    if (!cache.isValid()) {
+        file.remove();
+        return YouTubeCache();
+    }
+    return cache;
+}
+
+// thread-safe
+static auto writeCache(const QString &url, const YouTubeCache &cache) -> void
+{
+    QJsonObject json;
+    json[u"url"_q] = url;
+    json[u"time"_q] = (double)cache.time;
+    json[u"cookies"_q] = QString::fromLatin1(cache.cookies.toBase64());
+    json[u"json"_q] = cache.json;
+    QFile file(cachePath(url));
+    if (file.open(QFile::WriteOnly | QFile::Truncate))
+        file.write(QJsonDocument(json).toJson(QJsonDocument::Compact));
+    else
+        _Warn("Cannot write cache for %%", url);
+}
+
 struct YouTubeDL::Data {
     YouTubeDL *p = nullptr;
     QTemporaryDir cookieDir;
@@ -112,22 +181,153 @@ struct YouTubeDL::Data {
     QString input;
     Error error = NoError;
     QProcess *proc = nullptr;
+    bool waiting = false;
     int timeout = 60000;
     QMutex mutex;
+    QWaitCondition resolved;
     QJsonObject json;
     bool ask = false;
     int height = 720, fps = 0;
     QString container = u"webm"_q;
+    // urls being resolved in pool and memory cache; guarded by mutex
+    QSet<QString> resolving;
+    QHash<QString, YouTubeCache> cache;
+    QSet<QProcess*> workers;
+    QThreadPool pool;
+    bool quit = false;
+
+    auto cookies(const QString &url) const -> QString
+        { return cookieDir.path() % "/cookies-"_a % cacheKey(url); }
+    // thread-safe; runs youtube-dl and waits for it in calling thread
+    auto exec(QProcess &proc, const QString &url, QJsonObject &json) -> Error;
+    // call with mutex locked
+    auto find(const QString &url) -> YouTubeCache
+    {
+        auto it = cache.find(url);
+        if (it != cache.end()) {
+            if (it->isValid())
+                return *it;
+            cache.erase(it);
+        }
+        auto entry = readCache(url);
+        if (entry.isValid()) {
+            QFile file(cookies(url));
+            if (!entry.cookies.isEmpty() && file.open(QFile::WriteOnly | QFile::Truncate))
+                file.write(entry.cookies);
+            cache.insert(url, entry);
+        }
+        return entry;
+    }
+    // call with mutex locked
+    auto store(const QString &url, const QJsonObject &json) -> void
+    {
+        YouTubeCache entry;
+        entry.json = json;
+        entry.time = QDateTime::currentMSecsSinceEpoch();
+        QFile file(cookies(url));
+        if (file.open(QFile::ReadOnly))
+            entry.cookies = file.readAll();
+        cache.insert(url, entry);
+        writeCache(url, entry);
+    }
 };
 
+class YouTubeResolver : public QRunnable {
+public:
+    YouTubeResolver(YouTubeDL::Data *d, const QString &url)
+        : d(d), m_url(url) { }
+private:
+    auto run() -> void final
+    {
+        QProcess proc;
+        QJsonObject json;
+        QMutexLocker locker(&d->mutex);
+        auto error = YouTubeDL::Canceled;
+        if (!d->quit) {
+            d->workers.insert(&proc);
+            locker.unlock();
+            error = d->exec(proc, m_url, json);
+            locker.relock();
+            d->workers.remove(&proc);
+        }
+        if (!error && !d->quit)
+            d->store(m_url, json);
+        d->resolving.remove(m_url);
+        d->resolved.wakeAll();
+    }
+    YouTubeDL::Data *d = nullptr;
+    const QString m_url;
+};
+
+auto YouTubeDL::Data::exec(QProcess &proc, const QString &url, QJsonObject &json) -> Error
+{
+    mutex.lock();
+    const auto program = this->program;
+    const auto userAgent = this->userAgent;
+    const auto timeout = this->timeout;
+    mutex.unlock();
+
+    const auto cookies = this->cookies(url);
+    QFile(cookies).remove();
+    QStringList args;
+    if (!userAgent.isEmpty())
+        args << u"--user-agent"_q << userAgent;
+    args << u"--cookies"_q << cookies;
+    args << u"--flat-playlist"_q << u"--no-playlist"_q << u"--all-subs"_q;
+    args << u"--sub-format"_q
+         << (url.contains("crunchyroll.com"_a, Qt::CaseInsensitive) ? u"ass"_q : u"srt"_q);
+    args << u"-J"_q << url;
+
+    proc.start(program, args, QProcess::ReadOnly);
+    if (!proc.waitForFinished(timeout))
+        proc.kill();
+    auto translateError = [&] () {
+        switch (proc.error()) {
+        case QProcess::FailedToStart:
+            return FailedToStart;
+        case QProcess::Crashed:
+            return Crashed;
+        case QProcess::ReadError:
+            return ReadError;
+        case QProcess::UnknownError:
+            return NoError;
+        default:
+            return UnknownError;
+        }
+    };
+    auto error = translateError();
+    if (!error && (proc.exitStatus() != QProcess::NormalExit || proc.exitCode()))
+        error = UnknownError;
+    if (error) {
+        auto out = proc.readAllStandardOutput().trimmed();
+        if (!out.isEmpty())
+            _Warn("%%", out);
+        auto err = proc.readAllStandardError().trimmed();
+        if (!err.isEmpty())
+            _Error("%%", err);
+        return error;
+    }
+    auto out = proc.readAllStandardOutput().trimmed();
+    json = _JsonFromString(_L(std::move(out)));
+    return NoError;
+}
+
 YouTubeDL::YouTubeDL(QObject *parent)
     : QObject(parent), d(new Data)
 {
     d->p = this;
+    d->pool.setMaxThreadCount(MaxResolvers);
 }
 
 YouTubeDL::~YouTubeDL()
 {
+    d->pool.clear();
+    d->mutex.lock();
+    d->quit = true;
+    for (auto proc : d->workers)
+        proc->kill();
+    d->mutex.unlock();
+    d->pool.waitForDone();
     delete d;
 }
 
@@ -256,84 +456,71 @@ auto YouTubeDL::result() const -> Result
 
 auto YouTubeDL::cookies() const -> QString
 {
-    return d->cookieDir.path() % "/cookies"_a;
+    return d->cookies(d->input);
 }
 
 auto YouTubeDL::userAgent() const -> QString
 {
+    QMutexLocker locker(&d->mutex);
     return d->userAgent;
 }
 
 auto YouTubeDL::setUserAgent(const QString &ua) -> void
 {
+    QMutexLocker locker(&d->mutex);
     d->userAgent = ua;
 }
 
 auto YouTubeDL::cancel() -> void
 {
     QMutexLocker locker(&d->mutex);
-    if (!d->proc)
+    if (!d->proc && !d->waiting)
         return;
     if (!d->error)
         d->error = Canceled;
-    d->proc->kill();
+    if (d->proc)
+        d->proc->kill();
+    d->resolved.wakeAll();
+}
+
+auto YouTubeDL::prefetch(const QStringList &urls) -> void
+{
+    QMutexLocker locker(&d->mutex);
+    for (auto &url : urls) {
+        if (d->resolving.contains(url) || d->find(url).isValid())
+            continue;
+        d->resolving.insert(url);
+        d->pool.start(new YouTubeResolver(d, url));
+    }
 }
 
 auto YouTubeDL::run(const QString &url) -> bool
 {
-    QProcess proc;
+    QMutexLocker locker(&d->mutex);
     d->input = url;
     d->json = QJsonObject();
     d->error = NoError;
-    QFile(cookies()).remove();
-    QStringList args;
-    if (!d->userAgent.isEmpty())
-        args << u"--user-agent"_q << d->userAgent;
-    args << u"--cookies"_q << cookies();
-    args << u"--flat-playlist"_q << u"--no-playlist"_q << u"--all-subs"_q;
-    args << u"--sub-format"_q
-         << (url.contains("crunchyroll.com"_a, Qt::CaseInsensitive) ? u"ass"_q : u"srt"_q);
-    args << u"-J"_q << d->input;
-
-    d->mutex.lock();
-    d->proc = &proc;
-    d->mutex.unlock();
-    proc.start(d->program, args, QProcess::ReadOnly);
-    if (!proc.waitForFinished(d->timeout))
-        proc.kill();
-    d->mutex.lock();
-    d->proc = nullptr;
-    d->mutex.unlock();
-    if (!d->error && proc.error() != QProcess::UnknownError) {
-        auto translateError = [&] () {
-            switch (proc.error()) {
-            case QProcess::FailedToStart:
-                return FailedToStart;
-            case QProcess::Crashed:
-                return Crashed;
-            case QProcess::ReadError:
-                return ReadError;
-            case QProcess::UnknownError:
-                return NoError;
-            default:
-                return UnknownError;
-            }
-        };
-        d->error = translateError();
-    }
-    if (!d->error && (proc.exitStatus() != QProcess::NormalExit || proc.exitCode()))
-        d->error = UnknownError;
-    if (d->error) {
-        auto out = proc.readAllStandardOutput().trimmed();
-        if (!out.isEmpty())
-            _Warn(out);
-        auto err = proc.readAllStandardError().trimmed();
-        if (!err.isEmpty())
-            _Error(err);
+    // prefetch in progress; take its result rather than starting another
+    d->waiting = true;
+    while (d->resolving.contains(url) && !d->error)
+        d->resolved.wait(&d->mutex);
+    d->waiting = false;
+    if (d->error)
         return false;
+    auto json = d->find(url).json;
+    if (json.isEmpty()) {
+        QProcess proc;
+        d->proc = &proc;
+        locker.unlock();
+        const auto error = d->exec(proc, url, json);
+        locker.relock();
+        d->proc = nullptr;
+        if (!d->error)
+            d->error = error;
+        if (d->error)
+            return false;
+        d->store(url, json);
     }
-    auto out = proc.readAllStandardOutput().trimmed();
-    const auto json =_JsonFromString(_L(std::move(out)));
 
     // ported from mpv/player/lua/ytdl_hook.lua
     if (json[u"direct"_q].toBool())
@@ -344,11 +531,13 @@ auto YouTubeDL::run(const QString &url) -> bool
 
 auto YouTubeDL::program() const -> QString
 {
+    QMutexLocker locker(&d->mutex);
     return d->program;
 }
 
 auto YouTubeDL::setProgram(const QString &program) -> void
 {
+    QMutexLocker locker(&d->mutex);
     d->program = program;
 }
 
@@ -356,6 +545,8 @@ auto YouTubeDL::supports(const QString &url) -> bool
 {
     if (!url.startsWith("http://"_a) && !url.startsWith("https://"_a))
         return false;
+    if (readCache(url).isValid())
+        return true;
 
     QProcess proc;
     QStringList args;
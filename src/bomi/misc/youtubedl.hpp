@@ -57,13 +57,17 @@ public:
     auto setTimeout(int timeout) -> void;
     auto timeout() const -> int;
     auto cookies() const -> QString;
+    // blocks until url is resolved; reuses cached or prefetched result
     auto run(const QString &url) -> bool;
+    // resolves urls in background with bounded number of processes
+    auto prefetch(const QStringList &urls) -> void;
     auto error() const -> Error;
     auto result() const -> Result;
     auto cancel() -> void;
     auto setPreferredFormat(int height, int fps, const QString &container) -> void;
     auto select(const QList<YouTubeFormat> &formats) const -> int;
 private:
+    friend class YouTubeResolver;
     struct Data;
     Data *d;
 };
@@ -13,6 +13,7 @@ public:
         m_counter = 0;
     }
     void destroy() { m_timer.destroy(); }
+    void reset() { m_ns = 0; m_counter = 0; }
     void begin() { m_timer.begin(); }
     void end();
     void setMaxCount(int n) { m_max = n; }
@@ -87,6 +87,8 @@ auto check() -> QString
     checkExtension("GLX_EXT_swap_control"_b, ExtSwapControl);
     checkExtension("GLX_SGI_swap_control"_b, SgiSwapControl);
     checkExtension("GLX_MESA_swap_control"_b, MesaSwapControl);
+    checkExtension("GL_ARB_sync"_b, Sync, 3, 2);
+    checkExtension("GL_ARB_map_buffer_range"_b, MapBufferRange, 3);
 
     if (QOpenGLFramebufferObject::hasOpenGLFramebufferObjects()) {
         extensions.push_back(u"GL_ARB_framebuffer_object"_q);
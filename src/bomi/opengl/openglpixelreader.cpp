@@ -0,0 +1,159 @@
+#include "openglpixelreader.hpp"
+#include "opengltexture2d.hpp"
+#include "opengltexturebinder.hpp"
+#include "misc/log.hpp"
+
+DECLARE_LOG_CONTEXT(OpenGL)
+
+struct Slot {
+    GLuint buffer = GL_NONE;
+    GLsync fence = nullptr;
+    int capacity = 0, tag = 0;
+    QSize size;
+    QImage::Format format = QImage::Format_Invalid;
+};
+
+struct OpenGLPixelReader::Data {
+    QVector<Slot> slots;
+    int head = 0, count = 0;
+    bool resolved = false;
+    PFNGLFENCESYNCPROC fenceSync = nullptr;
+    PFNGLCLIENTWAITSYNCPROC clientWaitSync = nullptr;
+    PFNGLDELETESYNCPROC deleteSync = nullptr;
+    PFNGLMAPBUFFERRANGEPROC mapBufferRange = nullptr;
+    PFNGLUNMAPBUFFERPROC unmapBuffer = nullptr;
+    auto resolve() -> bool
+    {
+        if (resolved)
+            return fenceSync;
+        resolved = true;
+        auto ctx = QOpenGLContext::currentContext();
+        if (!ctx)
+            return false;
+#define GET(f, name) f = reinterpret_cast<decltype(f)>(ctx->getProcAddress(name))
+        GET(fenceSync, "glFenceSync");
+        GET(clientWaitSync, "glClientWaitSync");
+        GET(deleteSync, "glDeleteSync");
+        GET(mapBufferRange, "glMapBufferRange");
+        GET(unmapBuffer, "glUnmapBuffer");
+#undef GET
+        if (!fenceSync || !clientWaitSync || !deleteSync
+                || !mapBufferRange || !unmapBuffer) {
+            _Warn("Cannot resolve functions for asynchronous readback.");
+            fenceSync = nullptr;
+        }
+        return fenceSync;
+    }
+    auto at(int i) -> Slot& { return slots[(head + i) % slots.size()]; }
+    // free slot after last pending one, growing ring if needed
+    auto acquire() -> Slot*
+    {
+        if (count < slots.size())
+            return &at(count);
+        if (slots.size() >= MaxSlots)
+            return nullptr;
+        // rotate so that pending slots are contiguous from 0 before growing
+        std::rotate(slots.begin(), slots.begin() + head, slots.end());
+        head = 0;
+        slots.push_back(Slot());
+        return &slots.last();
+    }
+};
+
+OpenGLPixelReader::OpenGLPixelReader()
+    : d(new Data) { }
+
+OpenGLPixelReader::~OpenGLPixelReader()
+{
+    destroy();
+    delete d;
+}
+
+auto OpenGLPixelReader::isAvailable() -> bool
+{
+    return OGL::hasExtension(OGL::Sync) && OGL::hasExtension(OGL::MapBufferRange);
+}
+
+auto OpenGLPixelReader::pending() const -> int
+{
+    return d->count;
+}
+
+auto OpenGLPixelReader::read(const OpenGLTexture2D &texture,
+                             QImage::Format format, int tag) -> bool
+{
+    if (texture.isEmpty() || texture.id() == GL_NONE || !d->resolve())
+        return false;
+    auto slot = d->acquire();
+    if (!slot)
+        return false;
+    auto f = OGL::func();
+    const int bytes = texture.width() * texture.height() * 4;
+    if (slot->buffer == GL_NONE)
+        f->glGenBuffers(1, &slot->buffer);
+    f->glBindBuffer(GL_PIXEL_PACK_BUFFER, slot->buffer);
+    if (slot->capacity != bytes) {
+        f->glBufferData(GL_PIXEL_PACK_BUFFER, bytes, nullptr, GL_STREAM_READ);
+        slot->capacity = bytes;
+    }
+    {
+        auto self = const_cast<OpenGLTexture2D*>(&texture);
+        OpenGLTextureBinder<OGL::Target2D> binder(self);
+        glGetTexImage(texture.target(), 0, GL_BGRA,
+                      GL_UNSIGNED_INT_8_8_8_8_REV, nullptr);
+    }
+    f->glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    slot->fence = d->fenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slot->size = texture.size();
+    slot->format = format;
+    slot->tag = tag;
+    ++d->count;
+    return true;
+}
+
+auto OpenGLPixelReader::take() -> QVector<Result>
+{
+    QVector<Result> results;
+    auto f = OGL::func();
+    while (d->count > 0) {
+        auto &slot = d->at(0);
+        const auto ret = d->clientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+        if (ret == GL_TIMEOUT_EXPIRED)
+            break;
+        d->deleteSync(slot.fence);
+        slot.fence = nullptr;
+        Result result;
+        result.tag = slot.tag;
+        f->glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+        auto data = ret == GL_WAIT_FAILED ? nullptr
+                : d->mapBufferRange(GL_PIXEL_PACK_BUFFER, 0, slot.capacity, GL_MAP_READ_BIT);
+        if (data) {
+            result.image = QImage(slot.size, slot.format);
+            const int stride = slot.size.width() * 4;
+            for (int y = 0; y < slot.size.height(); ++y)
+                memcpy(result.image.scanLine(y), (const uchar*)data + y * stride, stride);
+            d->unmapBuffer(GL_PIXEL_PACK_BUFFER);
+        } else
+            _Error("Failed to map pixel buffer.");
+        f->glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        results.push_back(result);
+        d->head = (d->head + 1) % d->slots.size();
+        --d->count;
+    }
+    return results;
+}
+
+auto OpenGLPixelReader::destroy() -> void
+{
+    auto f = OGL::func();
+    if (f) {
+        for (auto &slot : d->slots) {
+            if (slot.fence)
+                d->deleteSync(slot.fence);
+            if (slot.buffer != GL_NONE)
+                f->glDeleteBuffers(1, &slot.buffer);
+        }
+    }
+    d->slots.clear();
+    d->head = d->count = 0;
+}
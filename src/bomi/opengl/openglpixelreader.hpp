@@ -0,0 +1,34 @@
+#ifndef OPENGLPIXELREADER_HPP
+#define OPENGLPIXELREADER_HPP
+
+class OpenGLTexture2D;
+
+// asynchronous readback of textures through pixel buffer objects
+// read() only queues copy into a buffer with a fence and take() maps
+// buffers whose fences have been signaled, so that caller never waits GPU
+// all methods have to be called in the thread of current context
+
+class OpenGLPixelReader {
+public:
+    static constexpr int MaxSlots = 6;
+    struct Result {
+        QImage image;
+        int tag = 0;
+    };
+    OpenGLPixelReader();
+    ~OpenGLPixelReader();
+    // requires GL_ARB_sync and GL_ARB_map_buffer_range
+    static auto isAvailable() -> bool;
+    // returns false if all slots are busy
+    auto read(const OpenGLTexture2D &texture, QImage::Format format,
+              int tag = 0) -> bool;
+    // finished readbacks in queued order; never blocks
+    auto take() -> QVector<Result>;
+    auto pending() const -> int;
+    auto destroy() -> void;
+private:
+    struct Data;
+    Data *d;
+};
+
+#endif // OPENGLPIXELREADER_HPP
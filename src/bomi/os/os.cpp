@@ -147,6 +147,11 @@ auto HwAcc::download(mp_hwdec_ctx *, const mp_image *, mp_image_pool *) -> mp_im
     return nullptr;
 }
 
+auto HwAcc::downloadLuma(mp_hwdec_ctx *, const mp_image *, int, LumaPlane *) -> bool
+{
+    return false;
+}
+
 #ifndef Q_OS_WIN
 auto setImeEnabled(QWindow *w, bool enabled) -> void
 {
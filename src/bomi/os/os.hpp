@@ -5,7 +5,7 @@
 
 enum class DeintMethod;                 enum class CodecId;
 struct mp_image_pool;                   struct mp_image;
-struct mp_hwdec_ctx;
+struct mp_hwdec_ctx;                    class LumaPlane;
 
 namespace OS {
 
@@ -103,6 +103,9 @@ public:
     auto description() const -> QString;
     virtual auto download(mp_hwdec_ctx *ctx, const mp_image *mpi,
                           mp_image_pool *pool) -> mp_image*;
+    // decimated luma only; false if not supported
+    virtual auto downloadLuma(mp_hwdec_ctx *ctx, const mp_image *mpi,
+                              int step, LumaPlane *luma) -> bool;
     static auto fullCodecList() -> QList<CodecId>;
     static auto name(Api api) -> QString;
     static auto description(Api api) -> QString;
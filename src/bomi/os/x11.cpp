@@ -4,6 +4,7 @@
 
 #include "tmp/algorithm.hpp"
 #include "enum/codecid.hpp"
+#include "video/lumaplane.hpp"
 #include <QDesktopWidget>
 #include <QMouseEvent>
 #include <QtDBus/QDBusConnection>
@@ -500,22 +501,21 @@ auto shutdown() -> bool
     Iface kde(u"org.kde.ksmserver"_q, u"/KSMServer"_q,
               u"org.kde.KSMServerInterface"_q, bus);
     auto response = kde.call(u"logout"_q, 0, 2, 2);
-    auto check = [&] (const char *fmt, const char *fb) -> bool {
+    auto check = [&] (const char *what, const char *fb) -> bool {
         if (response.type() != QDBusMessage::ErrorMessage)
             return true;
-        _Debug(fmt, response.errorName(), response.errorMessage());
-        _Debug(fb);
+        _Debug("%% does not work: [%%] %%", what,
+               response.errorName(), response.errorMessage());
+        _Debug("%%", fb);
         return false;
     };
-    if (check("KDE session manager does not work: [%%] %%",
-              "Fallback to Gnome session manager."))
+    if (check("KDE session manager", "Fallback to Gnome session manager."))
         return true;
     Iface gnome(u"org.gnome.SessionManager"_q,
                 u"/org/gnome/SessionManager"_q,
                 u"org.gnome.SessionManager"_q, bus);
     response = gnome.call(u"RequestShutdown"_q);
-    if (check("Gnome session manager does not work: [%%] %%",
-              "Fallback to gnome-power-cmd.sh."))
+    if (check("Gnome session manager", "Fallback to gnome-power-cmd.sh."))
         return true;
     if (QProcess::startDetached(u"gnome-power-cmd.sh shutdown"_q)
             || QProcess::startDetached(u"gnome-power-cmd shutdown"_q))
@@ -527,14 +527,13 @@ auto shutdown() -> bool
               u"/org/freedesktop/Hal/devices/computer"_q,
               u"org.freedesktop.Hal.Device.SystemPowerManagement"_q, bus);
     response = hal.call(u"Shutdown"_q);
-    if (check("HAL does not work: [%%] %%", "Fallback to ConsoleKit."))
+    if (check("HAL", "Fallback to ConsoleKit."))
         return true;
     Iface consoleKit(u"org.freedesktop.ConsoleKit"_q,
                      u"/org/freedesktop/ConsoleKit/Manager"_q,
                      u"org.freedesktop.ConsoleKit.Manager"_q, bus);
     response = consoleKit.call(u"Stop"_q);
-    if (check("ConsoleKit does not work: [%%] %%",
-              "Sorry, there's no way to shutdown."))
+    if (check("ConsoleKit", "Sorry, there's no way to shutdown."))
         return true;
     return false;
 }
@@ -693,6 +692,37 @@ auto VaApiInfo::download(mp_hwdec_ctx *ctx, const mp_image *mpi,
     return img;
 }
 
+auto VaApiInfo::downloadLuma(mp_hwdec_ctx *ctx, const mp_image *mpi,
+                             int step, LumaPlane *luma) -> bool
+{
+    auto va = ctx->vaapi_ctx;
+    if (!va)
+        return false;
+    // map surface directly and read only sampled rows of luma plane
+    const auto id = va_surface_id((mp_image*)mpi);
+    VAImage image;
+    va_lock(va);
+    auto status = vaSyncSurface(va->display, id);
+    if (status == VA_STATUS_SUCCESS)
+        status = vaDeriveImage(va->display, id, &image);
+    va_unlock(va);
+    if (status != VA_STATUS_SUCCESS)
+        return false;
+    mp_image plane;
+    bool ok = va_image_map(va, &image, &plane);
+    if (ok) {
+        plane.pts = mpi->pts;
+        plane.params.colorlevels = mpi->params.colorlevels;
+        mp_image_set_size(&plane, mpi->w, mpi->h);
+        ok = luma->decimate(&plane, step);
+        va_image_unmap(va, &image);
+    }
+    va_lock(va);
+    vaDestroyImage(va->display, image.image_id);
+    va_unlock(va);
+    return ok;
+}
+
 #endif
 
 /******************************************************************************/
@@ -779,6 +809,25 @@ auto VdpauInfo::download(mp_hwdec_ctx *ctx, const mp_image *mpi,
     return nullptr;
 }
 
+auto VdpauInfo::downloadLuma(mp_hwdec_ctx *ctx, const mp_image *mpi,
+                             int step, LumaPlane *luma) -> bool
+{
+    if (!ctx->vdpau_ctx)
+        return false;
+    // VDPAU cannot read a part of surface, but reuse buffer at least
+    auto img = luma->scratch(IMGFMT_420P, mpi->w, mpi->h);
+    if (!img)
+        return false;
+    const VdpVideoSurface surface = (intptr_t)mpi->planes[3];
+    if (ctx->vdpau_ctx->vdp.video_surface_get_bits_y_cb_cr(
+                surface, VDP_YCBCR_FORMAT_YV12, (void* const*)img->planes,
+                (uint32_t*)img->stride) != VDP_STATUS_OK)
+        return false;
+    img->pts = mpi->pts;
+    img->params.colorlevels = mpi->params.colorlevels;
+    return luma->decimate(img, step);
+}
+
 #endif
 
 } // namespace OS
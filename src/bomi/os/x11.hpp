@@ -104,6 +104,8 @@ struct VaApiInfo : public HwAccX11 {
     VaApiInfo();
     auto download(mp_hwdec_ctx *ctx, const mp_image *mpi,
                   mp_image_pool *pool) -> mp_image* final;
+    auto downloadLuma(mp_hwdec_ctx *ctx, const mp_image *mpi,
+                      int step, LumaPlane *luma) -> bool final;
 };
 
 #endif
@@ -114,6 +116,8 @@ struct VdpauInfo : public HwAccX11 {
     VdpauInfo();
     auto download(mp_hwdec_ctx *ctx, const mp_image *mpi,
                   mp_image_pool *pool) -> mp_image* final;
+    auto downloadLuma(mp_hwdec_ctx *ctx, const mp_image *mpi,
+                      int step, LumaPlane *luma) -> bool final;
 private:
     QVector<QByteArray> m_errors;
     VdpDevice m_device = 0;
@@ -2,13 +2,16 @@
 
 auto ABRepeatChecker::check(int time) -> bool
 {
-    if (!m_repeating || time <= m_b)
+    const int last = m_last;
+    m_last = time;
+    if (!m_repeating)
         return false;
-    if (m_times < 0)
-        return true;
-    if (m_times <= ++m_nth)
-        stop();
-    return true;
+    if (last > m_a && time < last && time <= m_a + Tolerance) {
+        if (m_times >= 0 && m_times <= ++m_nth)
+            stop();
+        return false;
+    }
+    return time > m_b + Tolerance;
 }
 
 auto ABRepeatChecker::start(int times) -> bool
@@ -17,6 +20,7 @@ auto ABRepeatChecker::start(int times) -> bool
         stop();
     m_times = times;
     m_nth = 0;
+    m_last = -1;
     m_repeating = (m_a >= 0 && m_b > m_a);
     return m_repeating;
 }
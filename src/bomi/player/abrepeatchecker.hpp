@@ -1,13 +1,17 @@
 #ifndef ABREPEATCHECKER_HPP
 #define ABREPEATCHECKER_HPP
 
+// mpv loops by itself with ab-loop-a/b checked on every frame and
+// seeking exactly; this counts loops by detecting jump back to A and
+// catches time past B which mpv ignores, e.g., after seeking beyond B
+
 class ABRepeatChecker {
 public:
     ABRepeatChecker() noexcept { }
     ~ABRepeatChecker() noexcept { stop(); }
     auto repeat(int a, int b, int times = -1) -> bool
         { m_a = a; m_b = b; return start(times); }
-    auto isRepeating() -> bool { return m_repeating; }
+    auto isRepeating() const -> bool { return m_repeating; }
     auto a() const -> int { return m_a; }
     auto b() const -> int { return m_b; }
     auto hasA() const -> bool { return m_a >= 0; }
@@ -17,10 +21,12 @@ public:
     auto stop() -> void { m_repeating = false; }
     auto setA(int a) -> int { return m_a = a; }
     auto setB(int b) -> int { return m_b = b; }
+    // returns true if seeking to A is required
     auto check(int time) -> bool;
     auto start(int times = -1) -> bool;
 private:
-    int m_a = -1, m_b = -1;
+    static constexpr int Tolerance = 250;
+    int m_a = -1, m_b = -1, m_last = -1;
     bool m_repeating = false;
     int m_times = 0, m_nth = 0;
 };
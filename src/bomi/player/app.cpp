@@ -6,6 +6,8 @@
 #include "misc/json.hpp"
 #include "misc/locale.hpp"
 #include "misc/objectstorage.hpp"
+#include "misc/mediaindex.hpp"
+#include "misc/startuptracer.hpp"
 #include "quick/appobject.hpp"
 #include "rootmenu.hpp"
 #include "os/os.hpp"
@@ -42,7 +44,7 @@ auto translator_load(const Locale &locale) -> bool;
 enum class LineCmd {
     Wake, Open, Action, LogLevel, Debug,
     DumpApiTree, DumpActionList, WinAssoc, WinUnassoc, WinAssocDefault,
-    SetSubtitle, AddSubtitle,
+    SetSubtitle, AddSubtitle, CheckSkins,
 };
 
 static const QCommandLineOption s_dummy{u"__dummy__"_q};
@@ -235,6 +237,7 @@ App::App(int &argc, char **argv)
 #endif
 
     OS::initialize();
+    MediaIndex::initialize();
 
     _New(d->parser);
     d->parser->addOption(LineCmd::Open, u"open"_q,
@@ -256,6 +259,8 @@ App::App(int &argc, char **argv)
                          u"Dump API structure tree to stdout."_q);
     d->parser->addOption(LineCmd::DumpActionList, u"dump-action-list"_q,
                          u"Dump executable action list to stdout."_q);
+    d->parser->addOption(LineCmd::CheckSkins, u"check-skins"_q,
+                         u"Load all skins and print their loading cost."_q);
 #ifdef Q_OS_WIN
     d->parser->addOption(LineCmd::WinAssoc, u"win-assoc"_q,
                          u"Associate given comma-separated extension list."_q, u"ext"_q);
@@ -325,6 +330,7 @@ App::~App() {
     delete d;
     OS::finalize();
     RootMenu::finalize();
+    MediaIndex::finalize();
     delete d->parser;
 }
 
@@ -393,6 +399,11 @@ auto App::isOpenGLDebugLoggerRequested() const -> bool
     return d->gldebug;
 }
 
+auto App::isSkinCheckRequested() const -> bool
+{
+    return d->parser->isSet(LineCmd::CheckSkins);
+}
+
 auto App::setMainWindow(MainWindow *mw) -> void
 {
     d->main = mw;
@@ -510,6 +521,7 @@ auto App::sendMessage(MessageType type, const QJsonValue &json, int timeout) ->
 
 auto App::setLocale(const Locale &locale) -> void
 {
+    StartupTracer::Scope trace("App::setLocale");
     if (translator_load(locale))
         d->locale = locale;
 }
@@ -37,6 +37,7 @@ public:
     auto setUnique(bool unique) -> void;
     auto runCommands() -> void;
     auto isOpenGLDebugLoggerRequested() const -> bool;
+    auto isSkinCheckRequested() const -> bool;
     auto setMprisActivated(bool activated) -> void;
     auto sendMessage(MessageType type, const QJsonValue &t, int timeout = 5000) -> bool;
     auto sendMessage(MessageType type, const QStringList &t, int timeout = 5000) -> bool;
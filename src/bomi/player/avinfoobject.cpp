@@ -206,6 +206,70 @@ auto VideoObject::delayedTime() const -> qreal
 
 /******************************************************************************/
 
+auto FrameTimingObject::report() const -> QVariantMap
+{
+    QVariantMap map;
+    for (int i = 0; i < FrameTimings::StageCount; ++i) {
+        const auto stage = static_cast<FrameTimings::Stage>(i);
+        const auto s = m_timings.summary(stage);
+        QVariantMap summary;
+        summary[u"count"_q] = s.count;
+        summary[u"p50"_q] = s.p50;
+        summary[u"p90"_q] = s.p90;
+        summary[u"p99"_q] = s.p99;
+        summary[u"max"_q] = s.max;
+        map[_L(FrameTimings::name(stage))] = summary;
+    }
+    QVariantList late;
+    for (auto count : m_timings.lateHistogram())
+        late.push_back(count);
+    map[u"late"_q] = late;
+    return map;
+}
+
+auto FrameTimingObject::text() const -> QString
+{
+    QStringList list;
+    for (auto stage : { FrameTimings::FilterIn, FrameTimings::FilterOut,
+                        FrameTimings::Deinterlacer, FrameTimings::Interpolator,
+                        FrameTimings::Render, FrameTimings::Vsync }) {
+        const auto s = m_timings.summary(stage);
+        if (s.count > 0)
+            list.push_back(_L(FrameTimings::name(stage)) % '='_q % _N(s.p50, 2)
+                           % '/'_q % _N(s.p99, 2));
+    }
+    return list.join(u", "_q);
+}
+
+auto FrameTimingObject::lateText() const -> QString
+{
+    const auto bins = m_timings.lateHistogram();
+    int total = 0;
+    for (auto count : bins)
+        total += count;
+    if (!total)
+        return QString();
+    QStringList list;
+    for (int i = 0; i < (int)bins.size(); ++i)
+        list.push_back(_N(i + 1) % (i == (int)bins.size() - 1 ? "+="_a : "="_a)
+                       % _N(bins[i] * 100.0 / total, 1) % '%'_q);
+    return list.join(u", "_q);
+}
+
+auto FrameTimingObject::update() -> void
+{
+    if (!m_updated.isValid() || m_updated.elapsed() >= 1000) {
+        m_updated.start();
+        emit updated();
+    }
+}
+
+void FrameTimingObject::reset()
+{
+    m_timings.clear();
+    emit updated();
+}
+
 SubtitleObject::SubtitleObject()
     : AvCommonObject(StreamSubtitle)
 {
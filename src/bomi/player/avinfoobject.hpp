@@ -3,6 +3,7 @@
 
 #include "enum/colorrange.hpp"
 #include "enum/colorspace.hpp"
+#include "video/frametimings.hpp"
 #include <QQmlListProperty>
 
 class AudioFormat;                      class StreamTrack;
@@ -261,6 +262,27 @@ private:
     ColorRange m_range = ColorRange::Auto;
 };
 
+class FrameTimingObject : public QObject {
+    Q_OBJECT
+    Q_PROPERTY(QVariantMap report READ report NOTIFY updated)
+    Q_PROPERTY(QString text READ text NOTIFY updated)
+    Q_PROPERTY(QString lateText READ lateText NOTIFY updated)
+public:
+    auto recorder() -> FrameTimings* { return &m_timings; }
+    // stage -> {count, p50, p90, p99, max} in ms, and late histogram of vsync
+    auto report() const -> QVariantMap;
+    auto text() const -> QString;
+    auto lateText() const -> QString;
+    // throttled to emit updated() once a second
+    auto update() -> void;
+    Q_INVOKABLE void reset();
+signals:
+    void updated();
+private:
+    FrameTimings m_timings;
+    QElapsedTimer m_updated;
+};
+
 class VideoObject : public AvCommonObject {
     Q_OBJECT
     Q_PROPERTY(VideoFormatObject *decoder READ decoder CONSTANT FINAL)
@@ -275,6 +297,7 @@ class VideoObject : public AvCommonObject {
     Q_PROPERTY(qreal droppedFps READ droppedFps NOTIFY droppedFpsChanged)
     Q_PROPERTY(qint64 frameNumber READ frameNumber NOTIFY frameNumberChanged)
     Q_PROPERTY(qint64 frameCount READ frameCount NOTIFY frameCountChanged)
+    Q_PROPERTY(FrameTimingObject *timings READ timings CONSTANT FINAL)
 public:
     VideoObject();
     auto decoder() const -> const VideoFormatObject* { return &m_decoder; }
@@ -287,6 +310,8 @@ public:
     auto hwacc() const -> const VideoToolObject* { return &m_hwacc; }
     auto deint() -> VideoToolObject* { return &m_deint; }
     auto deint() const -> const VideoToolObject* { return &m_deint; }
+    auto timings() -> FrameTimingObject* { return &m_timings; }
+    auto timings() const -> const FrameTimingObject* { return &m_timings; }
     auto droppedFrames() const -> int { return m_dropped; }
     auto droppedFps() const -> qreal { return m_droppedFps; }
     auto delayedFrames() const -> int { return m_delayed; }
@@ -314,6 +339,7 @@ signals:
 private:
     VideoFormatObject m_decoder, m_filter, m_output;
     VideoToolObject m_hwacc, m_deint;
+    FrameTimingObject m_timings;
     int m_dropped = 0, m_delayed = 0;
     qreal m_droppedFps = 0.0, m_fpsMp = 1;
     qint64 m_frameCount = 0, m_frameNumber = 0;
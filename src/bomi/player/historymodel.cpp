@@ -1,6 +1,9 @@
 #include "historymodel.hpp"
 #include "mrlstatesqlfield.hpp"
 #include "misc/log.hpp"
+#include "misc/startuptracer.hpp"
+#include "misc/mediaindex.hpp"
+#include "video/videoanalyzer.hpp"
 #include <QSqlDatabase>
 #include <QSqlError>
 #include <QQuickItem>
@@ -109,6 +112,14 @@ struct HistoryModel::Data {
         rowCache = RowCache();
         return true;
     }
+    // list is queried when it is shown for the first time
+    auto invalidate() -> void
+    {
+        if (visible)
+            load();
+        else
+            reload = true;
+    }
     auto import(const QVector<MrlState*> &states) -> void
     {
         Transactor t(&db);
@@ -134,6 +145,7 @@ struct HistoryModel::Data {
 
 HistoryModel::HistoryModel(QObject *parent)
 : QAbstractTableModel(parent), d(new Data) {
+    StartupTracer::Scope trace("HistoryModel");
     d->p = this;
     auto &metaObject = MrlState::staticMetaObject;
     const int count = metaObject.propertyCount();
@@ -189,7 +201,9 @@ HistoryModel::HistoryModel(QObject *parent)
             }
         }
     }
-    d->load();
+    d->finder.exec(u"CREATE TABLE IF NOT EXISTS video_analysis "
+                   "(mrl TEXT PRIMARY KEY, mtime INTEGER, data BLOB)"_q);
+    d->check(d->finder);
 }
 
 HistoryModel::~HistoryModel() {
@@ -245,7 +259,7 @@ auto HistoryModel::play(int row) -> void
 auto HistoryModel::setShowMediaTitleInName(bool local, bool url) -> void
 {
     if (_Change(d->mediaTitleLocal, local) | _Change(d->mediaTitleUrl, url))
-        d->load();
+        d->invalidate();
 }
 
 auto HistoryModel::getData(const int row, int role) const -> QVariant
@@ -335,7 +349,7 @@ auto HistoryModel::setStarred(int row, bool star) -> void
 
 auto HistoryModel::update() -> void
 {
-    d->load();
+    d->invalidate();
 }
 
 auto HistoryModel::update(const MrlState *state, const QString &column, bool reload) -> void
@@ -411,8 +425,44 @@ auto HistoryModel::clear() -> void
     QMutexLocker locker(&d->mutex);
     Transactor t(&d->db);
     d->loader.exec("DELETE FROM "_a % d->table % " WHERE star != 1 OR star IS NULL"_a);
+    d->finder.exec(u"DELETE FROM video_analysis"_q);
     t.done();
-    d->load();
+    d->invalidate();
+}
+
+SIA mtimeOf(const Mrl &mrl) -> qint64
+{
+    return MediaIndex::mtime(QFileInfo(mrl.toLocalFile()));
+}
+
+auto HistoryModel::videoAnalysis(const Mrl &mrl) const -> VideoAnalysis
+{
+    if (!mrl.isLocalFile())
+        return VideoAnalysis();
+    QMutexLocker locker(&d->mutex);
+    d->finder.prepare(u"SELECT mtime, data FROM video_analysis WHERE mrl = ?"_q);
+    d->finder.addBindValue(mrl.toString());
+    if (!d->finder.exec() || !d->finder.next())
+        return VideoAnalysis();
+    // file has been replaced since analyzed
+    if (d->finder.value(0).toLongLong() != mtimeOf(mrl))
+        return VideoAnalysis();
+    return VideoAnalysis::fromByteArray(d->finder.value(1).toByteArray());
+}
+
+auto HistoryModel::setVideoAnalysis(const Mrl &mrl, const VideoAnalysis &analysis) -> void
+{
+    if (!mrl.isLocalFile() || analysis.isEmpty())
+        return;
+    QMutexLocker locker(&d->mutex);
+    Transactor t(&d->db);
+    d->finder.prepare(u"INSERT OR REPLACE INTO video_analysis "
+                      "(mrl, mtime, data) VALUES (?, ?, ?)"_q);
+    d->finder.addBindValue(mrl.toString());
+    d->finder.addBindValue(mtimeOf(mrl));
+    d->finder.addBindValue(analysis.toByteArray());
+    d->finder.exec();
+    d->check(d->finder);
 }
 
 auto HistoryModel::isVisible() const -> bool
@@ -422,6 +472,9 @@ auto HistoryModel::isVisible() const -> bool
 
 auto HistoryModel::setVisible(bool visible) -> void
 {
-    if (_Change(d->visible, visible))
+    if (_Change(d->visible, visible)) {
+        if (d->visible && d->reload)
+            d->load();
         emit visibleChanged(d->visible);
+    }
 }
@@ -4,6 +4,7 @@
 #include "mrlstate.hpp"
 
 class QSqlError;
+struct VideoAnalysis;
 
 class HistoryModel: public QAbstractTableModel {
     Q_OBJECT
@@ -27,6 +28,8 @@ public:
     auto setPropertiesToRestore(const QStringList &properties) -> void;
     auto isRestorable(const char *name) const -> bool;
     auto clear() -> void;
+    auto videoAnalysis(const Mrl &mrl) const -> VideoAnalysis;
+    auto setVideoAnalysis(const Mrl &mrl, const VideoAnalysis &analysis) -> void;
     auto isVisible() const -> bool;
     auto setVisible(bool visible) -> void;
     auto update() -> void;
@@ -3,6 +3,16 @@
 #include "json/jrcommon.hpp"
 #include "misc/jsonstorage.hpp"
 
+// paths from scripts are arbitrary; drop all if too many
+static constexpr int MaxCachedTargets = 1024;
+
+struct JrTarget {
+    QObject *object = nullptr;
+    QByteArray list; // name of list if path ends with list.length
+    QMetaProperty property;
+    QVector<QMetaMethod> methods;
+};
+
 struct JrPlayer::Data {
     AppObject app;
     QMetaObject *mo = nullptr;
@@ -64,10 +74,124 @@ struct JrPlayer::Data {
             auto param = _JsonToQVariant(json[_L(names[i])], method.parameterType(i));
             if (!param.isValid())
                 return QJsonValue::Undefined;
-            params.push_back(params);
+            params.push_back(param);
         }
         return invoke(object, method, params);
     }
+
+    // components of dotted path with list index or -1
+    struct Step { QByteArray name; int index = -1; };
+    using Steps = QVector<Step>;
+    // members found by name per class; objects are not cached
+    // because any property along a path can change to another one
+    struct Member {
+        QMetaProperty property;
+        QVector<QMetaMethod> methods;
+    };
+    QHash<QString, Steps> paths;
+    // keyed by class name because meta object of QML type can be freed
+    // and its address reused for another type
+    QHash<QPair<QByteArray, QByteArray>, Member> members;
+
+    auto steps(const QString &path) -> const Steps&
+    {
+        auto it = paths.constFind(path);
+        if (it != paths.cend())
+            return *it;
+        if (paths.size() >= MaxCachedTargets)
+            paths.clear();
+        Steps steps;
+        for (auto &ref : path.splitRef('.'_q)) {
+            Step step;
+            step.name = ref.toUtf8();
+            const int left = step.name.indexOf('[');
+            if (left > 0) {
+                const int right = step.name.indexOf(']', left);
+                bool ok = right > 0;
+                if (ok)
+                    step.index = step.name.mid(left + 1, right - (left + 1)).toInt(&ok);
+                if (!ok || step.index < 0) {
+                    steps.clear();
+                    break;
+                }
+                step.name.truncate(left);
+            }
+            steps.push_back(step);
+        }
+        if (!steps.isEmpty() && steps.front().name == "App" && steps.front().index < 0)
+            steps.pop_front();
+        return *paths.insert(path, steps);
+    }
+
+    auto member(const QMetaObject *mo, const QByteArray &name) -> const Member&
+    {
+        const auto key = qMakePair(QByteArray(mo->className()), name);
+        auto it = members.constFind(key);
+        if (it != members.cend())
+            return *it;
+        if (members.size() >= MaxCachedTargets)
+            members.clear();
+        Member member;
+        const int idx = mo->indexOfProperty(name);
+        if (idx >= 0)
+            member.property = mo->property(idx);
+        else {
+            for (int i = 0; i < mo->methodCount(); ++i) {
+                if (mo->method(i).name() == name)
+                    member.methods.push_back(mo->method(i));
+            }
+        }
+        return *members.insert(key, member);
+    }
+
+    // follow object properties and list items in path from App
+    // pos is left at the first step which is not an object
+    auto walk(const Steps &steps, int &pos) -> QObject*
+    {
+        QObject *object = &app;
+        for (pos = 0; pos + 1 < steps.size(); ++pos) {
+            const auto &step = steps[pos];
+            QObject *obj = nullptr;
+            if (step.index >= 0) {
+                QQmlListReference list(object, step.name);
+                if (!list.isValid() || !(obj = list.at(step.index)))
+                    return nullptr;
+            } else {
+                const auto &p = member(object->metaObject(), step.name).property;
+                if (p.isValid())
+                    obj = p.read(object).value<QObject*>();
+                if (!obj)
+                    return object;
+            }
+            object = obj;
+        }
+        return object;
+    }
+
+    auto resolve(const QString &path) -> JrTarget
+    {
+        JrTarget target;
+        const auto &steps = this->steps(path);
+        int pos = 0;
+        const auto object = walk(steps, pos);
+        if (!object || pos >= steps.size())
+            return target;
+        const auto &step = steps[pos];
+        if (step.index >= 0 || step.name.isEmpty())
+            return target;
+        if (pos + 1 < steps.size()) {
+            if (pos + 2 != steps.size() || steps[pos + 1].name != "length"
+                    || steps[pos + 1].index >= 0)
+                return target;
+            target.list = step.name;
+        } else {
+            const auto &m = member(object->metaObject(), step.name);
+            target.property = m.property;
+            target.methods = m.methods;
+        }
+        target.object = object;
+        return target;
+    }
 };
 
 JrPlayer::JrPlayer(QObject *parent)
@@ -83,92 +207,76 @@ JrPlayer::~JrPlayer()
 auto JrPlayer::request(const JrRequest &request) -> JrResponse
 {
     Q_ASSERT(request.isValid());
-    QObject *object = &d->app;
-    int pos = 0;
-    const auto jrMethod = request.method();
     const auto jrParams = request.params();
-    if (jrMethod.startsWith("App."_a))
-        pos = 4;
     auto error = [&] (JrError e) { return _JrErrorResponse(request.id(), e); };
-    while (pos < jrMethod.size()) {
-        const int next = jrMethod.indexOf('.'_q, pos);
-        if (next > pos) {
-            const auto name = jrMethod.midRef(pos, next - pos).toUtf8();
-            pos = next + 1;
-            const int left = name.indexOf('[');
-            if (left > 0) {
-                QQmlListReference list(object, name.left(left));
-                const int right = name.indexOf(']', left);
-                if (!list.isValid() || right < 0)
-                    break;
-                bool ok = false;
-                const int idx = name.mid(left + 1, right - (left + 1)).toInt(&ok);
-                const auto obj = list.at(idx);
-                if (!ok || !obj)
-                    break;
-                object = obj;
-                continue;
-            }
-            const auto p = object->property(name);
-            if (auto obj = p.value<QObject*>()) {
-                object = obj;
-                continue;
-            }
-            QQmlListReference list(object, name);
-            if (!list.isValid() || jrMethod.midRef(pos) != "length"_a)
-                break;
-            return { request, list.count() };
-        }
-        const auto name = jrMethod.midRef(pos).toUtf8();
-        pos = jrMethod.size();
-        if (name.isEmpty())
-            break;
+    const auto target = d->resolve(request.method());
+    const auto object = target.object;
+    if (!object)
+        return error(JrError::MethodNotFound);
+    if (!target.list.isEmpty()) {
+        QQmlListReference list(object, target.list);
+        if (!list.isValid())
+            return error(JrError::MethodNotFound);
+        return { request, list.count() };
+    }
 
-        const auto mo = object->metaObject();
-        const int idx = mo->indexOfProperty(name);
-        if (idx >= 0) {
-            const auto p = mo->property(idx);
-            if (!jrParams.isUndefined()) {
-                QJsonValue value(QJsonValue::Undefined);
-                if (jrParams.isArray()) {
-                    auto array = jrParams.toArray();
-                    if (array.size() != 1)
-                        return error(JrError::InvalidParams);
-                    value = array.at(0);
-                } else if (jrParams.isObject()) {
-                    auto object = jrParams.toObject();
-                    if (object.size() != 1)
-                        return error(JrError::InvalidParams);
-                    value = object.begin().value();
-                }
-                if (value.isUndefined())
+    if (target.property.isValid()) {
+        const auto &p = target.property;
+        if (!jrParams.isUndefined()) {
+            QJsonValue value(QJsonValue::Undefined);
+            if (jrParams.isArray()) {
+                auto array = jrParams.toArray();
+                if (array.size() != 1)
                     return error(JrError::InvalidParams);
-                auto var = _JsonToQVariant(value, p.userType());
-                if (!var.isValid())
+                value = array.at(0);
+            } else if (jrParams.isObject()) {
+                auto object = jrParams.toObject();
+                if (object.size() != 1)
                     return error(JrError::InvalidParams);
-                if (!p.write(object, var))
-                    return error(JrError::MethodNotFound);
+                value = object.begin().value();
             }
-            const auto res = _JsonFromQVariant(p.read(object));
-            if (!res.isUndefined())
-                return { request, res };
-            return _JrErrorResponse(request.id(), JrError::InternalError);
+            if (value.isUndefined())
+                return error(JrError::InvalidParams);
+            auto var = _JsonToQVariant(value, p.userType());
+            if (!var.isValid())
+                return error(JrError::InvalidParams);
+            if (!p.write(object, var))
+                return error(JrError::MethodNotFound);
         }
+        const auto res = _JsonFromQVariant(p.read(object));
+        if (!res.isUndefined())
+            return { request, res };
+        return _JrErrorResponse(request.id(), JrError::InternalError);
+    }
 
-        for (int i = 0; i < mo->methodCount(); ++i) {
-            if (mo->method(i).name() != name)
-                continue;
-            QJsonValue res(QJsonValue::Undefined);
-            if (jrParams.isArray())
-                res = d->invoke(object, mo->method(i), jrParams.toArray());
-            else if (jrParams.isObject())
-                res = d->invoke(object, mo->method(i), jrParams.toObject());
-            else if (jrParams.isUndefined())
-                res = d->invoke(object, mo->method(i), QJsonArray());
-            if (!res.isUndefined())
-                return { request, res };
-        }
-        return _JrErrorResponse(request.id(), JrError::InvalidParams);
+    for (auto &method : target.methods) {
+        QJsonValue res(QJsonValue::Undefined);
+        if (jrParams.isArray())
+            res = d->invoke(object, method, jrParams.toArray());
+        else if (jrParams.isObject())
+            res = d->invoke(object, method, jrParams.toObject());
+        else if (jrParams.isUndefined())
+            res = d->invoke(object, method, QJsonArray());
+        if (!res.isUndefined())
+            return { request, res };
     }
-    return _JrErrorResponse(request.id(), JrError::MethodNotFound);
+    return _JrErrorResponse(request.id(), JrError::InvalidParams);
+}
+
+auto JrPlayer::subscribe(const QString &path, QObject *parent) -> JrSubscription*
+{
+    const auto target = d->resolve(path);
+    const auto object = target.object;
+    const auto p = target.property;
+    if (!object || !p.isValid() || !p.hasNotifySignal())
+        return nullptr;
+    QPointer<QObject> guard = object;
+    return new JrSubscription(object, p, [guard, p] () -> QJsonValue {
+        if (!guard)
+            return QJsonValue::Null;
+        const auto var = p.read(guard);
+        if (const auto obj = var.value<QObject*>())
+            return _JsonFromQObject(obj);
+        return _JsonFromQVariant(var);
+    }, parent);
 }
@@ -9,6 +9,7 @@ public:
     ~JrPlayer();
 private:
     auto request(const JrRequest &request) -> JrResponse final;
+    auto subscribe(const QString &path, QObject *parent) -> JrSubscription* final;
     struct Data;
     Data *d;
 };
@@ -2,6 +2,8 @@
 #include "dialog/mbox.hpp"
 #include "json/jrserver.hpp"
 #include "player/jrplayer.hpp"
+#include "player/skin.hpp"
+#include "misc/startuptracer.hpp"
 #include <QCryptographicHash>
 #include <QElapsedTimer>
 #ifdef Q_OS_LINUX
@@ -45,7 +47,12 @@ int main(int argc, char **argv) {
 
     registerType();
 
-    QScopedPointer<App> app(new App(argc, argv));
+    StartupTracer::mark("main");
+    QScopedPointer<App> app;
+    {
+        StartupTracer::Scope trace("App");
+        app.reset(new App(argc, argv));
+    }
 
 #ifdef Q_OS_WIN
     const char sep = ';';
@@ -61,7 +68,11 @@ int main(int argc, char **argv) {
     if (app->executeToQuit())
         return 0;
 
-    const auto error = OGL::check();
+    QString error;
+    {
+        StartupTracer::Scope trace("OGL::check");
+        error = OGL::check();
+    }
     if (!error.isEmpty()) {
         MBox mbox(nullptr, MBox::Icon::Critical,
                   qApp->translate("OpenGL", "OpenGL Error"),
@@ -76,9 +87,21 @@ int main(int argc, char **argv) {
     }
     qsrand(QDateTime::currentMSecsSinceEpoch());
 
-    MainWindow *mw = new MainWindow;
+    MainWindow *mw = nullptr;
+    {
+        StartupTracer::Scope trace("MainWindow");
+        mw = new MainWindow;
+    }
+    if (app->isSkinCheckRequested()) {
+        const int failed = Skin::check(mw->qmlEngine());
+        delete mw;
+        return failed > 0;
+    }
     _Debug("Show MainWindow.");
-    mw->show();
+    {
+        StartupTracer::Scope trace("MainWindow::show");
+        mw->show();
+    }
     app->setMainWindow(mw);
     _Debug("Start main event loop.");
 
@@ -53,6 +53,7 @@ auto registerType() -> void
     qmlRegisterType<AvTrackObject>();
     qmlRegisterType<VideoFormatObject>();
     qmlRegisterType<VideoToolObject>();
+    qmlRegisterType<FrameTimingObject>();
     qmlRegisterType<AudioFormatObject>();
     qmlRegisterType<AudioObject>();
     qmlRegisterType<CodecObject>();
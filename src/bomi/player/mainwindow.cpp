@@ -4,6 +4,7 @@
 #include "dialog/mbox.hpp"
 #include "dialog/encoderdialog.hpp"
 #include "quick/appobject.hpp"
+#include "misc/startuptracer.hpp"
 #include <QSessionManager>
 
 //DECLARE_LOG_CONTEXT(Main)
@@ -26,8 +27,11 @@ MainWindow::MainWindow()
 
     d->top = new TopLevelItem;
 
-    d->pref.initialize();
-    d->pref.load();
+    {
+        StartupTracer::Scope trace("Pref::load");
+        d->pref.initialize();
+        d->pref.load();
+    }
     d->undo.setActive(false);
     d->logViewer = d->dialog<LogViewer>();
     d->adapter = OS::adapter(this);
@@ -45,16 +49,37 @@ MainWindow::MainWindow()
     d->e.setHistory(&d->history);
     d->e.setYouTube(&d->youtube);
     d->e.setYle(&d->yle);
-    d->e.run();
+    {
+        StartupTracer::Scope trace("PlayEngine::run");
+        d->e.run();
+    }
 
-    d->initContextMenu();
-    d->initItems();
-    d->initTray();
-    d->plugEngine();
-    d->plugMenu();
+    {
+        StartupTracer::Scope trace("MainWindow::init");
+        d->initContextMenu();
+        d->initItems();
+        d->initTray();
+        d->plugEngine();
+        d->plugMenu();
+    }
 
-    connect(this, &QQuickView::statusChanged, this, [=] (Status status)
-        { if (status == Ready) d->top->setParentItem(contentItem()); });
+    connect(this, &QQuickView::statusChanged, this, [=] (Status status) {
+        if (status != Ready)
+            return;
+        d->top->setParentItem(contentItem());
+        if (StartupTracer::isFinished() || d->firstFrame.begin)
+            return;
+        // first frame is timed in render thread and reported in main thread
+        d->firstFrame.begin = StartupTracer::now();
+        d->firstFrame.stamp = connect(this, &QQuickWindow::frameSwapped, this, [=] ()
+            { if (!d->firstFrame.time) d->firstFrame.time = StartupTracer::now(); },
+            Qt::DirectConnection);
+        d->firstFrame.conn = connect(this, &QQuickWindow::frameSwapped, this, [=] () {
+            disconnect(d->firstFrame.stamp);
+            disconnect(d->firstFrame.conn);
+            StartupTracer::finish(d->firstFrame.time);
+        }, Qt::QueuedConnection);
+    });
     connect(d->adapter, &OS::WindowAdapter::stateChanged, this,
             [=] (Qt::WindowState ws) { d->updateWindowState(ws); });
     connect(this, &QQuickView::sceneGraphInitialized, this, [this] () {
@@ -81,7 +106,10 @@ MainWindow::MainWindow()
     connect(&cApp, &App::saveStateRequest, this, [=] (QSessionManager &session)
         { session.setRestartHint(QSessionManager::RestartIfRunning); });
 
-    d->restoreState();
+    {
+        StartupTracer::Scope trace("MainWindow::restoreState");
+        d->restoreState();
+    }
     d->undo.setActive(true);
     QTimer::singleShot(1, this, SLOT(postInitialize()));
 
@@ -111,7 +139,10 @@ auto MainWindow::postInitialize() -> void
         d->menu(u"window"_q)[u"frameless"_q]->trigger();
     d->as.restoreWindowGeometry(this);
     d->adapter->setImeEnabled(false);
-    d->applyPref();
+    {
+        StartupTracer::Scope trace("MainWindow::applyPref");
+        d->applyPref();
+    }
     cApp.runCommands();
     d->noMessage = false;
 }
@@ -5,6 +5,7 @@
 #include "misc/actiongroup.hpp"
 #include "subtitle/subtitleviewer.hpp"
 #include "subtitle/subtitlemodel.hpp"
+#include "subtitle/subtiming.hpp"
 #include "dialog/fileassocdialog.hpp"
 #include "dialog/mbox.hpp"
 #include "dialog/audioequalizerdialog.hpp"
@@ -22,6 +23,7 @@
 #include "audio/visualizer.hpp"
 #include "misc/filenamegenerator.hpp"
 #include <QThreadPool>
+#include <QInputDialog>
 #include <QClipboard>
 
 template<class T, class Func>
@@ -244,7 +246,11 @@ auto MainWindow::Data::plugMenu() -> void
                     ab.setB(-1);
                     msg(tr("Range is too short!"));
                 } else {
-                    ab.start();
+                    // failed start stops repeating so mpv should stop too
+                    if (ab.start())
+                        e.setABLoop(ab.a(), ab.b());
+                    else
+                        e.setABLoop(-1, -1);
                     msg(tr("Set B to %1. Start to repeat!").arg(time(at)));
                 }
             }
@@ -252,13 +258,17 @@ auto MainWindow::Data::plugMenu() -> void
         } case 's': {
             ab.setA(e.captionBeginTime());
             ab.setB(e.captionEndTime());
-            ab.start();
+            if (ab.start())
+                e.setABLoop(ab.a(), ab.b());
+            else
+                e.setABLoop(-1, -1);
             msg(tr("Repeat current subtitle"));
             break;
         } case 'q':
             ab.stop();
             ab.setA(-1);
             ab.setB(-1);
+            e.setABLoop(-1, -1);
             msg(tr("Quit repeating"));
         }
     });
@@ -295,7 +305,9 @@ auto MainWindow::Data::plugMenu() -> void
             auto target = e.chapter()->number() + offset;
             if (target > -2)
                 e.seekChapter(target);
-        }
+        } else if (e.seekToSceneCut(offset))
+            showMessage(offset < 0 ? tr("Seek to Previous Scene")
+                                   : tr("Seek to Next Scene"));
     };
     connect(play(u"chapter"_q)[u"prev"_q], &QAction::triggered,
             p, [seekChapter] () { seekChapter(-1); });
@@ -358,6 +370,54 @@ auto MainWindow::Data::plugMenu() -> void
     connectSnapshot(u"quick"_q, QuickSnapshot);
     connectSnapshot(u"quick-nosub"_q, QuickSnapshotNoSub);
     connectSnapshot(u"tool"_q, SnapshotTool);
+    connect(snap[u"range"_q], &QAction::triggered, p, [=] () {
+        static int a = -1;
+        if (e.isExportingFrames()) {
+            e.stopExportingFrames();
+        } else if (!e.hasVideoFrame()) {
+            a = -1;
+        } else if (a < 0) {
+            a = e.time();
+            showMessage(tr("Export Frames"), tr("Start from %1").arg(_MSecToString(a, u"hh:mm:ss.zzz"_q)));
+        } else {
+            const int b = e.time();
+            if (b - a < 100) {
+                showMessage(tr("Export Frames"), tr("Range is too short!"));
+                a = -1;
+                return;
+            }
+            bool ok = false;
+            const int every = QInputDialog::getInt(nullptr, tr("Export Frames"),
+                tr("Export every N-th frame from %1 to %2:")
+                    .arg(_MSecToString(a, u"hh:mm:ss.zzz"_q), _MSecToString(b, u"hh:mm:ss.zzz"_q)),
+                1, 1, 10000, 1, &ok);
+            if (ok) {
+                exportFolder = pref.quick_snapshot_folder();
+                if (pref.quick_snapshot_save() != QuickSnapshotSave::Fixed)
+                    exportFolder = e.mrl().isLocalFile() ? _ToAbsPath(e.mrl().toLocalFile()) : _LastOpenPath();
+                e.exportFrames(a, b, every);
+            }
+            a = -1;
+        }
+    });
+    connect(&e, &PlayEngine::frameExported, p, [=] (const QImage &frame, int time) {
+        if (exportFolder.isEmpty() || frame.isNull())
+            return;
+        auto g = fileNameGenerator();
+        g.start = g.end = QTime::fromMSecsSinceStartOfDay(time);
+        const auto format = pref.quick_snapshot_template() % "-%T_HOUR_0%%T_MIN_0%%T_SEC_0%%T_MSEC_0%"_a;
+        const auto file = g.get(exportFolder, format, pref.quick_snapshot_format());
+        const auto saver = new SnapshotSaver(frame, file, pref.quick_snapshot_quality());
+        if (saver->isWritable())
+            QThreadPool::globalInstance()->start(saver);
+        else {
+            delete saver;
+            e.stopExportingFrames();
+            MBox::error(nullptr, tr("Error"), tr("Failed to create next file:\n%1").arg(file), {BBox::Ok});
+        }
+    });
+    connect(&e, &PlayEngine::framesExported, p, [=] ()
+        { showMessage(tr("Export Frames"), exportFolder); });
     connect(&e, &PlayEngine::snapshotTaken, p, [this] () {
         QImage frameOnly, withOsd;
         ph.position = _MSecToTime(e.snapshot(&frameOnly, &withOsd));
@@ -714,6 +774,20 @@ auto MainWindow::Data::plugMenu() -> void
         const int time = e.captionBeginTime(a->data().toInt());
         if (time >= 0) push(e.time() - time, e.params()->sub_sync(), &PlayEngine::setSubtitleDelay);
     });
+    // anchors map the start of current line to now, two or more correct drift
+    connect(sub(u"sync"_q)[u"anchor"_q], &QAction::triggered, p, [=] () {
+        const int time = e.captionBeginTime(0);
+        if (time < 0)
+            return;
+        auto timing = e.subtitleTiming();
+        timing.addAnchor(timing.unmap(time), e.time() - e.params()->sub_sync());
+        e.setSubtitleTiming(timing);
+        showMessage(tr("Subtitle Anchors"), _N(timing.anchors().size()));
+    });
+    connect(sub(u"sync"_q)[u"clear-anchors"_q], &QAction::triggered, p, [=] () {
+        e.setSubtitleTiming(SubTiming());
+        showMessage(tr("Subtitle Anchors"), _N(0));
+    });
     PLUG_STEP(sub(u"scale"_q).g(), sub_scale, setSubtitleScale);
 
     Menu &tool = menu(u"tool"_q);
@@ -873,7 +947,7 @@ auto MainWindow::Data::plugMenu() -> void
         subFindDlg->show();
     });
     connect(tool[u"reload-skin"_q], &QAction::triggered,
-            p, [=] () { reloadSkin(); });
+            p, [=] () { reloadSkin(true); });
     connect(tool[u"auto-exit"_q], &QAction::triggered, p, [this] (bool on) {
         if (on != as.auto_exit)
             push(on, as.auto_exit, [this] (bool on) {
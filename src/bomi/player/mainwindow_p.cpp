@@ -19,6 +19,7 @@
 #include "avinfoobject.hpp"
 #include "misc/smbauth.hpp"
 #include "misc/filenamegenerator.hpp"
+#include "misc/mediaindex.hpp"
 #include <QSessionManager>
 #include <QScreen>
 
@@ -89,7 +90,8 @@ auto MainWindow::Data::initContextMenu() -> void
 
 auto MainWindow::Data::initTray() -> void
 {
-    if (!TrayIcon::isAvailable())
+    // created when enabled for the first time
+    if (tray || !pref.enable_system_tray() || !TrayIcon::isAvailable())
         return;
     tray = new TrayIcon(cApp.defaultIcon(), p);
     tray->setVisible(pref.enable_system_tray());
@@ -175,7 +177,11 @@ auto MainWindow::Data::plugEngine() -> void
     });
 #endif
     connect(&e, &PlayEngine::tick, p, [=] (int time) {
-        if (ab.check(time)) e.seek(ab.a());
+        const bool repeating = ab.isRepeating();
+        if (ab.check(time))
+            e.seek(ab.a());
+        if (repeating && !ab.isRepeating())
+            e.setABLoop(-1, -1);
 #ifdef Q_OS_WIN
         taskbar.progress()->setValue(time);
 #endif
@@ -525,24 +531,23 @@ auto MainWindow::Data::generatePlaylist(const Mrl &mrl) const -> Playlist
     Playlist list;
     const auto mode = pref.generate_playlist();
     const QFileInfo file(mrl.toLocalFile());
-    const QDir dir = file.dir();
-    const auto filter = _ToNameFilter(pref.exclude_images() ? VideoExt | AudioExt : MediaExt);
+    const auto exts = pref.exclude_images() ? VideoExt | AudioExt : MediaExt;
+    const auto folder = MediaIndex::instance().folder(file.absolutePath());
     if (mode == GeneratePlaylist::Folder) {
-        const auto files = dir.entryList(filter, QDir::Files, QDir::Name);
-        for (int i=0; i<files.size(); ++i)
-            list.push_back(dir.absoluteFilePath(files[i]));
+        for (auto &path : folder.files(exts))
+            list.push_back(path);
     } else {
-        const auto files = dir.entryInfoList(filter, QDir::Files, QDir::Name);
         const auto fileName = file.fileName();
         bool prefix = false, suffix = false;
-        auto it = files.cbegin();
-        for(; it != files.cend(); ++it) {
+        for (auto &entry : folder.entries) {
+            if (!_IsSuffixOf(exts, entry.suffix()))
+                continue;
             static QRegEx rxs(uR"((\D*)\d+(.*))"_q);
             const auto ms = rxs.match(fileName);
             if (!ms.hasMatch())
                 continue;
             static QRegEx rxt(uR"((\D*)\d+(.*))"_q);
-            const auto mt = rxt.match(it->fileName());
+            const auto mt = rxt.match(entry.name);
             if (!mt.hasMatch())
                 continue;
             if (!prefix && !suffix) {
@@ -559,7 +564,7 @@ auto MainWindow::Data::generatePlaylist(const Mrl &mrl) const -> Playlist
                 if (ms.capturedRef(2) != mt.capturedRef(2))
                     continue;
             }
-            list.append(it->absoluteFilePath());
+            list.append(folder.filePath(entry));
         }
     }
 
@@ -683,6 +688,7 @@ auto MainWindow::Data::applyPref() -> void
     theme.set(p.osd_theme());
     theme.set(controls);
     reloadSkin();
+    initTray();
     if (tray)
         tray->setVisible(p.enable_system_tray());
 
@@ -724,6 +730,7 @@ auto MainWindow::Data::applyPref() -> void
 
     e.setResume_locked(p.remember_stopped());
     e.setPreciseSeeking_locked(p.precise_seeking());
+    e.setVideoAnalysis_locked(p.analyze_video());
     e.setCache_locked(cache());
     e.setSmbAuth_locked(smb());
     e.setPriority_locked(p.audio_priority(), p.sub_priority());
@@ -776,18 +783,22 @@ auto MainWindow::Data::load(const Mrl &mrl, bool play, bool tryResume,
         e.setMrl(mrl);
 }
 
-auto MainWindow::Data::clear() -> void
+auto MainWindow::Data::clear(bool recompile) -> void
 {
     this->player = nullptr;
     p->setSource(QUrl());
-    p->qmlEngine()->clearComponentCache();
+    if (recompile)
+        p->qmlEngine()->clearComponentCache();
     p->releaseResources();
 }
 
-auto MainWindow::Data::reloadSkin() -> void
+auto MainWindow::Data::reloadSkin(bool recompile) -> void
 {
-    clear();
+    clear(recompile);
     Skin::apply(p, pref.skin_name());
+    // components shared with new skin are in use now and survive trimming
+    if (!recompile)
+        p->qmlEngine()->trimComponentCache();
     if (p->status() == QQuickView::Error) {
         QString msg;
         for (auto &error : p->errors())
@@ -845,6 +856,7 @@ auto MainWindow::Data::updateMrl(const Mrl &mrl) -> void
 {
     const auto disc = mrl.isDisc();
     playlist.setLoaded(mrl);
+    prefetchNext();
     auto action = menu(u"play"_q)[u"disc-menu"_q];
     action->setEnabled(disc);
     action->setVisible(disc);
@@ -859,6 +871,22 @@ auto MainWindow::Data::updateMrl(const Mrl &mrl) -> void
         p->setFilePath(QString());
 }
 
+auto MainWindow::Data::prefetchNext() -> void
+{
+    QStringList urls;
+    int row = playlist.next();
+    for (int i = 0; i < 2 && playlist.isValidRow(row); ++i, ++row) {
+        const auto url = playlist.value(row).toString();
+        if ((url.startsWith("http://"_a, Qt::CaseInsensitive)
+                || url.startsWith("https://"_a, Qt::CaseInsensitive)) && !yle.supports(url))
+            urls.push_back(QUrl(url).toString(QUrl::FullyEncoded));
+        if (playlist.isShuffled())
+            break;
+    }
+    if (!urls.isEmpty())
+        youtube.prefetch(urls);
+}
+
 auto MainWindow::Data::updateTitle() -> void
 {
     cApp.setWindowTitle(p, e.media()->name());
@@ -31,6 +31,7 @@
 #include <QMimeData>
 #include <QQmlProperty>
 #include <QQmlEngine>
+#include <atomic>
 
 #ifdef Q_OS_WIN
 #include <QWinTaskbarButton>
@@ -126,6 +127,12 @@ struct MainWindow::Data {
     QList<QAction*> unblockedActions;
     HistoryModel history;
     SnapshotMode snapshotMode = NoSnapshot;
+    struct {
+        qint64 begin = 0;
+        std::atomic<qint64> time{0}; // written in render thread
+        QMetaObject::Connection stamp, conn;
+    } firstFrame;
+    QString exportFolder;
 
     TopLevelItem *top = nullptr;
     OS::WindowAdapter *adapter = nullptr;
@@ -152,7 +159,7 @@ struct MainWindow::Data {
     template <class T = QObject>
     auto findItem(const QString &name = QString()) -> T*
         { return p->rootObject()->findChild<T*>(name); }
-    auto clear() -> void;
+    auto clear(bool recompile = false) -> void;
     auto resizeContainer() -> void;
     auto actionId(MouseBehavior mb, QInputEvent *event) const -> QString
         { return pref.mouse_action_map()[mb][event->modifiers()]; }
@@ -170,6 +177,8 @@ struct MainWindow::Data {
     auto setVideoSize(const QSize &video) -> void;
     auto updateRecentActions(const QList<Mrl> &list) -> void;
     auto updateMrl(const Mrl &mrl) -> void;
+    // resolve web urls in advance so that moving to next one does not wait
+    auto prefetchNext() -> void;
     auto updateTitle() -> void;
     auto showMessage(const QString &msg, const bool *force = nullptr) -> void;
     auto showMessage(const QString &cmd, const QString &desc) -> void
@@ -189,7 +198,8 @@ struct MainWindow::Data {
     auto plugMenu() -> void;
     auto load(const Mrl &mrl, bool play = true,
               bool tryResume = true, const QString &sub = QString()) -> void;
-    auto reloadSkin() -> void;
+    // recompile to pick up modified qml files
+    auto reloadSkin(bool recompile = false) -> void;
     auto trigger(QAction *action) -> void;
     auto setCursorVisible(bool visible) -> void;
     auto cancelToHideCursor() -> void;
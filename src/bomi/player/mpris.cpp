@@ -5,6 +5,7 @@
 #include "mainwindow.hpp"
 #include "player/avinfoobject.hpp"
 #include "misc/dataevent.hpp"
+#include <QElapsedTimer>
 
 namespace mpris {
 
@@ -41,9 +42,15 @@ RootObject::~RootObject()
 
 static auto dbusTrackId(const Mrl &mrl) -> QString
 {
-    using Hash = QCryptographicHash;
-    const auto hash = Hash::hash(mrl.toString().toUtf8(), Hash::Md5);
-    return "/net/xylosper/bomi/track_"_a % _L(hash.toHex().constData());
+    // metadata is rebuilt on every change; hash only when track changes
+    static QString location, id;
+    if (location != mrl.toString() || id.isEmpty()) {
+        using Hash = QCryptographicHash;
+        location = mrl.toString();
+        const auto hash = Hash::hash(location.toUtf8(), Hash::Md5);
+        id = "/net/xylosper/bomi/track_"_a % _L(hash.toHex().constData());
+    }
+    return id;
 }
 
 static auto sendPropertiesChanged(const QDBusAbstractAdaptor *adaptor,
@@ -57,24 +64,70 @@ static auto sendPropertiesChanged(const QDBusAbstractAdaptor *adaptor,
     QDBusConnection::sessionBus().send(sig);
 }
 
-SIA sendPropertiesChanged(const QDBusAbstractAdaptor *adaptor,
-                          const char *property, const QVariant &value) -> void
-{
-    QVariantMap props;
-    props.insert(_L(property), value);
-    sendPropertiesChanged(adaptor, props);
-}
+// merges changes in one PropertiesChanged message per event loop turn
+// and sends at most one message per interval given by BOMI_MPRIS_INTERVAL
+// in msec (100 by default) so that dragging volume does not flood bus
+class PropertyBatch {
+public:
+    PropertyBatch()
+    {
+        m_timer.setSingleShot(true);
+        QObject::connect(&m_timer, &QTimer::timeout, &m_timer, [=] () { flush(); });
+    }
+    auto setAdaptor(const QDBusAbstractAdaptor *adaptor) -> void { m_adaptor = adaptor; }
+    auto set(const char *property, const QVariant &value) -> void
+        { m_changed.insert(_L(property), value); schedule(); }
+    auto set(const QVariantMap &properties) -> void
+    {
+        for (auto it = properties.begin(); it != properties.end(); ++it)
+            m_changed.insert(it.key(), it.value());
+        schedule();
+    }
+private:
+    static auto interval() -> int
+    {
+        static const int interval = [] () {
+            bool ok = false;
+            const int ms = qgetenv("BOMI_MPRIS_INTERVAL").toInt(&ok);
+            return ok && ms >= 0 ? ms : 100;
+        }();
+        return interval;
+    }
+    auto schedule() -> void
+    {
+        if (m_timer.isActive())
+            return;
+        int wait = 0;
+        if (m_sent.isValid())
+            wait = qMax<qint64>(0, interval() - m_sent.elapsed());
+        m_timer.start(wait);
+    }
+    auto flush() -> void
+    {
+        if (m_changed.isEmpty() || !m_adaptor)
+            return;
+        sendPropertiesChanged(m_adaptor, m_changed);
+        m_changed.clear();
+        m_sent.start();
+    }
+    const QDBusAbstractAdaptor *m_adaptor = nullptr;
+    QVariantMap m_changed;
+    QTimer m_timer;
+    QElapsedTimer m_sent;
+};
 
 struct MediaPlayer2::Data {
     MainWindow *mw = nullptr;
+    PropertyBatch changed;
 };
 
 MediaPlayer2::MediaPlayer2(QObject *parent)
 : QDBusAbstractAdaptor(parent), d(new Data) {
     d->mw = cApp.mainWindow();
     Q_ASSERT(d->mw);
+    d->changed.setAdaptor(this);
     connect(d->mw, &MainWindow::fullscreenChanged,
-            [this] (bool fs) { sendPropertiesChanged(this, "Fullscreen", fs); });
+            [this] (bool fs) { d->changed.set("Fullscreen", fs); });
 }
 
 MediaPlayer2::~MediaPlayer2() {
@@ -190,6 +243,7 @@ struct Player::Data {
     QString playbackStatus, albumArt;
     QVariantMap metaData;
     Thread thread;
+    PropertyBatch changed;
     struct {
         QTimer timer;
         bool flag = false;
@@ -232,6 +286,7 @@ Player::Player(QObject *parent)
 {
     d->thread.p = this;
     d->thread.start();
+    d->changed.setAdaptor(this);
     d->mw = cApp.mainWindow();
     d->engine = d->mw->engine();
     d->playlist = d->mw->playlist();
@@ -246,25 +301,26 @@ Player::Player(QObject *parent)
         QVariantMap map;
         map[u"PlaybackStatus"_q] = d->playbackStatus;
         map[u"CanPause"_q] = map[u"CanPlay"_q] = state != PlayEngine::Error;
-        sendPropertiesChanged(this, map);
+        d->changed.set(map);
     });
     connect(d->engine, &PlayEngine::speedChanged, this, [this] () {
-        sendPropertiesChanged(this, "Rate", d->engine->speed());
+        d->changed.set("Rate", d->engine->speed());
     });
     auto checkNextPrevious = [this] () {
         QVariantMap map;
         map[u"CanGoNext"_q] = d->playlist->hasNext();
         map[u"CanGoPrevious"_q] = d->playlist->hasPrevious();
-        sendPropertiesChanged(this, map);
+        d->changed.set(map);
     };
     connect(d->playlist, &PlaylistModel::loadedChanged,
             this, checkNextPrevious);
     connect(d->engine, &PlayEngine::seekableChanged, this,
             [this] (bool seekable) {
-        sendPropertiesChanged(this, "CanSeek", seekable);
+        d->changed.set("CanSeek", seekable);
     });
     connect(d->engine, &PlayEngine::volumeChanged, this, [=] () {
-        sendPropertiesChanged(this, "volume", d->engine->volume());
+        d->volume = d->engine->volume();
+        d->changed.set("Volume", d->volume);
     });
     connect(d->engine, &PlayEngine::sought, this,
             [this] () { emit Seeked(time()); });
@@ -437,7 +493,7 @@ auto Player::SetPosition(const QDBusObjectPath &track, qint64 position) -> void
 auto Player::updateMetaData() -> void
 {
     d->metaData = d->toDBus(d->engine->metaData());
-    sendPropertiesChanged(this, "Metadata", d->metaData);
+    d->changed.set("Metadata", d->metaData);
 }
 
 auto Player::customEvent(QEvent *ev) -> void
@@ -140,6 +140,11 @@ auto Mpv::render(OpenGLFramebufferObject *frame, OpenGLFramebufferObject *osd, c
     return ret;
 }
 
+auto Mpv::render(int fbo, const QSize &size) -> int
+{
+    return mpv_opengl_cb_draw(d->gl, fbo, size.width(), -size.height());
+}
+
 auto Mpv::frameSwapped() -> void
 {
     mpv_opengl_cb_report_flip(d->gl, 0);
@@ -76,6 +76,9 @@ public:
     auto observe(const char *name, Get get, Set set) -> tmp::enable_if_callable_t<Get, int>;
     template<class T, class Update>
     auto observe(const char *name, T &t, Update update) -> tmp::enable_unless_callable_t<T, int>;
+    // coalesces changes which arrive before previous one has been processed
+    template<class Get, class Set>
+    auto observeLatest(const char *name, Get get, Set set) -> int;
     template<class Update>
     auto observeTime(const char *name, int &t, Update update) -> int;
     template<class Set>
@@ -91,6 +94,8 @@ public:
     auto update() -> void;
     auto render(OpenGLFramebufferObject *frame, OpenGLFramebufferObject *osd,
                 const QMargins &m) -> int;
+    // render into framebuffer of window whose y-axis is flipped
+    auto render(int fbo, const QSize &size) -> int;
     auto initializeGL(QOpenGLContext *ctx) -> void;
     auto finalizeGL() -> void;
     auto frameSwapped() -> void;
@@ -213,10 +218,19 @@ auto Mpv::observe(const char *name, T &t, Update update) -> tmp::enable_unless_c
                    [=, &t] (T &&v) { if (_Change(t, v)) update(); });
 }
 
+template<class Get, class Set>
+auto Mpv::observeLatest(const char *name, Get get, Set set) -> int
+{
+    using T = tmp::remove_cref_t<decltype(get())>;
+    auto slot = std::make_shared<DataSlot<T>>();
+    return newObservation(name, [=] (int e) { _PostLatest(m_observer, e, slot.get(), get()); },
+                          [=] (QEvent*) { set(slot->take()); });
+}
+
 template<class Update>
 auto Mpv::observeTime(const char *name, int &t, Update update) -> int
 {
-    return observe(name, [=] () { return s2ms(get<double>(name)); },
+    return observeLatest(name, [=] () { return s2ms(get<double>(name)); },
                    [=, &t] (int &&v) { if (_Change(t, v)) update(); });
 }
 
@@ -18,8 +18,12 @@ PlayEngine::PlayEngine()
     d->vr->setOverlay(d->sr);
     d->vr->setRenderFrameFunction([this] (Fbo *frame, Fbo* osd, const QMargins &m)
         { d->renderVideoFrame(frame, osd, m); });
+    d->vr->setRenderDirectFunction([this] (GLuint fbo, const QSize &size, bool newFrame)
+        { d->renderVideoDirect(fbo, size, newFrame); });
     d->updateVideoRendererFboFormat();
     d->info.video.setScreen(d->vr);
+    d->vp->setFrameTimings(d->info.video.timings()->recorder());
+    d->vr->setFrameTimings(d->info.video.timings()->recorder());
 
     d->params.m_mutex = &d->mutex;
 
@@ -184,6 +188,8 @@ PlayEngine::PlayEngine()
     connect(d->ac, &AudioController::spectrumObtained,
             &d->info.audio, &AudioObject::setSpectrum, Qt::QueuedConnection);
     connect(this, &PlayEngine::audioOnlyChanged, d->ac, &AudioController::setAnalyzeSpectrum);
+    connect(this, &PlayEngine::framesExported, d->vr,
+            [=] () { d->vr->setDirectRenderingEnabled(true); });
     connect(d->sr, &SubtitleRenderer::selectionChanged,
             this, &PlayEngine::subtitleSelectionChanged);
     connect(d->sr, &SubtitleRenderer::updated, this, &PlayEngine::subtitleUpdated);
@@ -195,6 +201,7 @@ PlayEngine::PlayEngine()
         d->info.video.decoder()->setBitrate(d->mpv.get<int>("video-bitrate"));
         d->info.video.setDelayedFrames(d->info.delayed);
         d->info.video.setDroppedFrames(d->mpv.get<int64_t>("vo-drop-frame-count"));
+        d->info.video.timings()->update();
     });
     connect(d->info.video.output(), &VideoFormatObject::sizeChanged,
             d->preview, &VideoPreview::setSizeHint);
@@ -276,13 +283,19 @@ PlayEngine::~PlayEngine()
 auto PlayEngine::initializeGL(const QQuickWindow *w, QOpenGLContext *ctx) -> void
 {
     d->mpv.initializeGL(ctx);
+    if (OpenGLPixelReader::isAvailable())
+        d->ss.reader = new OpenGLPixelReader;
     connect(w, &QQuickWindow::frameSwapped,
             &d->mpv, &Mpv::frameSwapped, Qt::DirectConnection);
+    auto timings = d->info.video.timings()->recorder();
+    connect(w, &QQuickWindow::frameSwapped, &d->mpv,
+            [=] () { timings->swapped(); }, Qt::DirectConnection);
 }
 
 auto PlayEngine::finalizeGL(QOpenGLContext */*ctx*/) -> void
 {
     d->mpv.finalizeGL();
+    _Delete(d->ss.reader);
 }
 
 auto PlayEngine::metaData() const -> const MetaData&
@@ -296,6 +309,16 @@ auto PlayEngine::setSubtitleDelay(int ms) -> void
         d->mpv.setAsync("sub-delay", ms * 1e-3);
 }
 
+auto PlayEngine::subtitleTiming() const -> const SubTiming&
+{
+    return d->sr->timing();
+}
+
+auto PlayEngine::setSubtitleTiming(const SubTiming &timing) -> void
+{
+    d->sr->setTiming(timing);
+}
+
 auto PlayEngine::cache() const -> CacheInfoObject*
 {
     return &d->info.cache;
@@ -696,6 +719,8 @@ auto PlayEngine::setAudioMuted(bool muted) -> void
 auto PlayEngine::shutdown() -> void
 {
     d->preview->shutdown();
+    if (d->analyzer)
+        d->analyzer->shutdown();
     d->mpv.tell("quit");
 }
 
@@ -710,11 +735,32 @@ auto PlayEngine::setPreciseSeeking_locked(bool on) -> void
         d->mpv.setAsync("options/hr-seek", on ? "yes"_b : "absolute"_b);
 }
 
+auto PlayEngine::setVideoAnalysis_locked(bool on) -> void
+{
+    if (!_Change(d->analyze, on))
+        return;
+    if (!d->analyze) {
+        if (d->analyzer)
+            d->analyzer->cancel();
+        return;
+    }
+    if (!d->analyzer) {
+        d->analyzer = new VideoAnalyzer(this);
+        connect(d->analyzer, &VideoAnalyzer::analyzed, this,
+                [=] (const Mrl &mrl, const VideoAnalysis &analysis) {
+            d->history->setVideoAnalysis(mrl, analysis);
+            if (mrl == d->mrl)
+                d->analysis = analysis;
+        });
+    }
+}
+
 auto PlayEngine::setMrl(const Mrl &mrl) -> void
 {
     if (d->mrl != mrl) {
         stop();
         d->mrl = mrl;
+        d->analysis = VideoAnalysis();
         d->updateMediaName();
         emit mrlChanged(d->mrl);
     }
@@ -1151,6 +1197,38 @@ auto PlayEngine::clearSnapshots() -> void
     d->ss.frame = d->ss.osd = QImage();
 }
 
+auto PlayEngine::exportFrames(int begin, int end, int every) -> void
+{
+    {
+        QMutexLocker locker(&d->burst.mutex);
+        d->burst.begin = qMax(0, begin);
+        d->burst.end = end;
+        d->burst.every = qMax(1, every);
+        d->burst.count = 0;
+        d->burst.last = -1;
+        d->burst.restarted = false;
+        d->burst.active = d->burst.begin <= end;
+    }
+    if (!d->burst.active)
+        return;
+    // frames are read from FBO
+    d->vr->setDirectRenderingEnabled(false);
+    seek(d->burst.begin);
+    if (isPaused())
+        unpause();
+}
+
+auto PlayEngine::stopExportingFrames() -> void
+{
+    if (d->burst.active.exchange(false))
+        emit framesExported();
+}
+
+auto PlayEngine::isExportingFrames() const -> bool
+{
+    return d->burst.active;
+}
+
 auto PlayEngine::setVideoHighQualityDownscaling(bool on) -> void
 {
     if (d->params.set_video_hq_downscaling(on))
@@ -1166,8 +1244,37 @@ auto PlayEngine::setVideoHighQualityUpscaling(bool on) -> void
 
 auto PlayEngine::seekToNextBlackFrame() -> void
 {
-    if (!isStopped())
+    if (isStopped())
+        return;
+    if (d->analysis.isEmpty()) {
         d->vp->skipToNextBlackFrame();
+        return;
+    }
+    // same limit as scanning in VideoProcessor
+    static constexpr int limit = 5*60*1000;
+    const int black = d->analysis.nextBlackFrame(time(), limit);
+    seek(black < 0 ? qMin(time() + limit, end()) : black);
+}
+
+auto PlayEngine::seekToSceneCut(int direction) -> bool
+{
+    if (isStopped() || d->analysis.isEmpty())
+        return false;
+    const int cut = d->analysis.sceneCut(time(), direction);
+    if (cut < 0)
+        return false;
+    seek(cut);
+    return true;
+}
+
+auto PlayEngine::setABLoop(int a, int b) -> void
+{
+    auto toMpv = [&] (int t) {
+        return t < 0 ? "no"_b : QByteArray::number((t + d->t.offset) * 1e-3, 'f', 3);
+    };
+    // set a first since setting b past current time seeks to a immediately
+    d->mpv.setAsync("ab-loop-a", toMpv(a));
+    d->mpv.setAsync("ab-loop-b", toMpv(b));
 }
 
 auto PlayEngine::waitingText() const -> QString
@@ -30,6 +30,7 @@ class OpenGLFramebufferObject;          class SubtitleRenderer;
 class SubCompModel;                     class MrlState;
 class QOpenGLContext;                   class EncodingInfo;
 class SubComp;                          class SmbAuth;
+class SubTiming;
 struct Autoloader;                      struct CacheInfo;
 struct IntrplParamSet;                  struct MotionIntrplOption;
 class AudioVisualizer;                  class QQuickWindow;
@@ -165,6 +166,7 @@ public:
     auto setAutoloader_locked(const Autoloader &audio, const Autoloader &sub) -> void;
     auto setResume_locked(bool resume) -> void;
     auto setPreciseSeeking_locked(bool on) -> void;
+    auto setVideoAnalysis_locked(bool on) -> void;
     auto setResyncAvWhenFilterToggled_locked(bool on) -> void;
     auto setMotionIntrplOption_locked(const MotionIntrplOption &option) -> void;
     auto unlock() -> void;
@@ -237,6 +239,9 @@ public:
     auto isMouseInButton() const -> bool;
     auto subtitle() const -> SubtitleObject*;
     auto setSubtitleDelay(int ms) -> void;
+    // retiming of external subtitles on top of delay
+    auto subtitleTiming() const -> const SubTiming&;
+    auto setSubtitleTiming(const SubTiming &timing) -> void;
     auto setNextMrl(const Mrl &Mrl) -> void;
     auto shutdown() -> void;
     auto stepFrame(int direction) -> void;
@@ -251,6 +256,9 @@ public:
     auto unpause() -> void;
     auto relativeSeek(int pos) -> void;
     auto seekToNextBlackFrame() -> void;
+    auto seekToSceneCut(int direction) -> bool;
+    // loop between a and b in msec on every frame; negative to clear
+    auto setABLoop(int a, int b) -> void;
 
     auto initializeGL(const QQuickWindow *w, QOpenGLContext *ctx) -> void;
     auto finalizeGL(QOpenGLContext *ctx) -> void;
@@ -286,6 +294,10 @@ public:
     auto takeSnapshot() -> void;
     auto snapshot(QImage *frame, QImage *osd) -> int;
     auto clearSnapshots() -> void;
+    // export every n-th rendered frame whose time is in [begin, end]
+    auto exportFrames(int begin, int end, int every = 1) -> void;
+    auto stopExportingFrames() -> void;
+    auto isExportingFrames() const -> bool;
     auto waitingText() const -> QString;
     auto stateText() const -> QString;
 
@@ -335,6 +347,8 @@ signals:
     void runningChanged();
     void deintOptionsChanged();
     void snapshotTaken();
+    void frameExported(const QImage &frame, int time);
+    void framesExported();
     void subtitleSelectionChanged();
     void framebufferObjectFormatChanged(FramebufferObjectFormat format);
     void audioOnlyChanged(bool audioOnly);
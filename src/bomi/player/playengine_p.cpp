@@ -477,10 +477,10 @@ auto PlayEngine::Data::observe() -> void
     mpv.observeState("paused-for-cache", [=] (bool b) { post(Buffering, b); });
     mpv.observeState("seeking", [=] (bool s) { post(Seeking, s); });
 
-    mpv.observe("cache-used", [=] () { return t.caching ? mpv.get<int>("cache-used") : 0; },
-                [=] (int v) { info.cache.setUsed(v); });
-    mpv.observe("cache-size", [=] () { return t.caching ? mpv.get<int>("cache-size") : 0; },
-                [=] (int v) { info.cache.setSize(v); });
+    mpv.observeLatest("cache-used", [=] () { return t.caching ? mpv.get<int>("cache-used") : 0; },
+                      [=] (int v) { info.cache.setUsed(v); });
+    mpv.observeLatest("cache-size", [=] () { return t.caching ? mpv.get<int>("cache-size") : 0; },
+                      [=] (int v) { info.cache.setSize(v); });
 
     mpv.observe("seekable", [=] () {
         return t.seekable >= 0 ? !!t.seekable : mpv.get<bool>("seekable");
@@ -497,7 +497,7 @@ auto PlayEngine::Data::observe() -> void
     };
 
     mpv.observeTime("avsync", avSync, [=] () { emit p->avSyncChanged(avSync); });
-    mpv.observe("time-pos", [=] () {
+    mpv.observeLatest("time-pos", [=] () {
         int ctime = 0;
         if (t.caching)
             ctime = s2ms(mpv.get<double>("demuxer-cache-time")) - t.offset;
@@ -768,6 +768,7 @@ auto PlayEngine::Data::request() -> void
         t.local.clear();
     });
     mpv.request(MPV_EVENT_PLAYBACK_RESTART, [=] () {
+        burst.restarted = true;
         _PostEvent(p, NotifySeek);
     });
 }
@@ -804,6 +805,10 @@ auto PlayEngine::Data::process(QEvent *event) -> void
         if (params.set_name(mpv.get<MpvUtf8>("media-title").data))
             history->update(&params, u"name"_q, false);
         history->update();
+        analysis = history->videoAnalysis(params.mrl());
+        if (analyze && analysis.isEmpty() && params.mrl().isLocalFile()
+                && _IsSuffixOf(VideoExt, params.mrl().suffix()))
+            analyzer->analyze(params.mrl());
         break;
     } case EndPlayback: {
         QSharedPointer<MrlState> last; int reason, error;
@@ -875,12 +880,66 @@ auto PlayEngine::Data::takeSnapshot() -> void
     }
     Fbo frame(size), osd(size);
     mpv.render(&frame, &osd, QMargins());
+    ss.time = mpv.get<double>("time-pos") * 1e3;
+    // textures can be deleted right after queuing; GL keeps them until copied
+    if (ss.reader && ss.reader->pending() + 2 <= OpenGLPixelReader::MaxSlots
+            && ss.reader->read(frame.texture(), QImage::Format_ARGB32, SnapshotFrame)
+            && ss.reader->read(osd.texture(), QImage::Format_ARGB32_Premultiplied, SnapshotOsd))
+        return;
     ss.frame = frame.texture().toImage(QImage::Format_ARGB32);
     ss.osd = osd.texture().toImage(QImage::Format_ARGB32_Premultiplied);
-    ss.time = mpv.get<double>("time-pos") * 1e3;
     emit p->snapshotTaken();
 }
 
+auto PlayEngine::Data::exportFrame(const Fbo *frame) -> void
+{
+    // frames before seeking to begin has been completed are stale
+    if (!burst.restarted)
+        return;
+    QMutexLocker locker(&burst.mutex);
+    const int time = s2ms(mpv.get<double>("time-pos")) - t.offset;
+    if (time == burst.last)
+        return;
+    burst.last = time;
+    if (time < burst.begin)
+        return;
+    if (time > burst.end) {
+        locker.unlock();
+        if (burst.active.exchange(false))
+            emit p->framesExported();
+        return;
+    }
+    if (burst.count++ % burst.every)
+        return;
+    if (ss.reader && ss.reader->read(frame->texture(), QImage::Format_ARGB32, time))
+        return;
+    if (ss.reader)
+        _Warn("Frame at %%ms is read synchronously since all pixel buffers are busy.", time);
+    emit p->frameExported(frame->texture().toImage(QImage::Format_ARGB32), time);
+}
+
+auto PlayEngine::Data::takeReadbacks() -> void
+{
+    if (!ss.reader)
+        return;
+    for (auto &result : ss.reader->take()) {
+        switch (result.tag) {
+        case SnapshotFrame:
+            ss.frame = result.image;
+            break;
+        case SnapshotOsd:
+            ss.osd = result.image;
+            emit p->snapshotTaken();
+            break;
+        default:
+            emit p->frameExported(result.image, result.tag);
+        }
+    }
+    // no new frame may come while paused; redraw to poll remaining fences
+    if (ss.reader->pending())
+        vr->updateForNewFrame(displaySize());
+}
+
 auto PlayEngine::Data::renderVideoFrame(Fbo *frame, Fbo *osd, const QMargins &m) -> void
 {
     info.delayed = mpv.render(frame, osd, m);
@@ -890,6 +949,23 @@ auto PlayEngine::Data::renderVideoFrame(Fbo *frame, Fbo *osd, const QMargins &m)
            "render queued frame(%%), avgfps: %%",
            frame->size(), info.video.output()->fps());
 
+    takeReadbacks();
+    if (ss.take) {
+        takeSnapshot();
+        ss.take = false;
+    }
+    if (burst.active)
+        exportFrame(frame);
+}
+
+auto PlayEngine::Data::renderVideoDirect(GLuint fbo, const QSize &size, bool newFrame) -> void
+{
+    const int delayed = mpv.render(fbo, size);
+    if (newFrame) {
+        info.delayed = delayed;
+        frames.measure.push(++frames.drawn);
+    }
+    takeReadbacks();
     if (ss.take) {
         takeSnapshot();
         ss.take = false;
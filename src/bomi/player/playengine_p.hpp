@@ -19,12 +19,15 @@
 #include "video/videorenderer.hpp"
 #include "video/videoprocessor.hpp"
 #include "video/videopreview.hpp"
+#include "video/videoanalyzer.hpp"
 #include "subtitle/subtitle.hpp"
 #include "subtitle/subtitlerenderer.hpp"
 #include "enum/codecid.hpp"
 #include "enum/framebufferobjectformat.hpp"
 #include "opengl/openglframebufferobject.hpp"
+#include "opengl/openglpixelreader.hpp"
 #include "os/os.hpp"
+#include <atomic>
 
 #ifdef bool
 #undef bool
@@ -67,6 +70,8 @@ struct PlayEngine::Data {
     Mpv mpv;
     VideoRenderer *vr = nullptr;
     VideoPreview *preview = nullptr;
+    VideoAnalyzer *analyzer = nullptr;
+    VideoAnalysis analysis;
     AudioController *ac = nullptr;
     SubtitleRenderer *sr = nullptr;
     VideoProcessor *vp = nullptr;
@@ -110,6 +115,7 @@ struct PlayEngine::Data {
     bool pauseAfterSkip = false, resume = false, hwdec = false;
     bool quit = false, preciseSeeking = false, mouseOnButton = false;
     bool filterResync = false, audioOnly = false, useIntrplDown = false;
+    bool analyze = false;
 
     QList<CodecId> hwCodecs;
 
@@ -132,7 +138,18 @@ struct PlayEngine::Data {
         SpeedMeasure<quint64> measure{5, 20};
     } frames;
 
-    struct { QImage osd, frame; bool take = false; int time = 0; } ss;
+    // tags of readbacks; nonnegative tag is time of exported frame
+    enum Readback { SnapshotFrame = -1, SnapshotOsd = -2 };
+    struct {
+        QImage osd, frame; bool take = false; int time = 0;
+        OpenGLPixelReader *reader = nullptr; // render thread only
+    } ss;
+    struct {
+        QMutex mutex;
+        std::atomic<bool> active{false}, restarted{false};
+        // last is time of last frame to skip redrawing same frame
+        int begin = 0, end = 0, every = 1, count = 0, last = -1;
+    } burst;
     QPoint mouse;
 
     auto resync(bool force = false) -> void;
@@ -164,6 +181,7 @@ struct PlayEngine::Data {
     auto updateVideoSubOptions() -> void;
     auto updateVideoRendererFboFormat() -> void;
     auto renderVideoFrame(Fbo *frame, Fbo *osd, const QMargins &m) -> void;
+    auto renderVideoDirect(GLuint fbo, const QSize &size, bool newFrame) -> void;
     auto displaySize() const { return info.video.output()->size(); }
     auto post(State state) -> void { _PostEvent(p, StateChange, state); }
     auto post(Waitings w, bool set) -> void { _PostEvent(p, WaitingChange, w, set); }
@@ -186,6 +204,8 @@ struct PlayEngine::Data {
         return true;
     }
     auto takeSnapshot() -> void;
+    auto exportFrame(const Fbo *frame) -> void;
+    auto takeReadbacks() -> void;
     auto localCopy() -> QSharedPointer<MrlState>;
     auto onLoad() -> void;
     auto onUnload() -> void;
@@ -152,7 +152,7 @@ auto PlaylistModel::setDownloader(Downloader *downloader) -> void
 {
     m_downloader = downloader;
     connect(m_downloader, &Downloader::finished, this, [this] () {
-        if (m_downloader->isCanceled())
+        if (m_downloader->isCanceled() || !m_downloader->errorString().isEmpty())
             return;
         auto data = m_downloader->takeData();
         const auto suffix = m_downloader->suffixes().value(0);
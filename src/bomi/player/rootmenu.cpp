@@ -3,6 +3,7 @@
 #include "video/videocolor.hpp"
 #include "misc/windowsize.hpp"
 #include "misc/log.hpp"
+#include "misc/startuptracer.hpp"
 #include "misc/stepactionpair.hpp"
 #include "misc/encodinginfo.hpp"
 #include "opengl/openglmisc.hpp"
@@ -261,6 +262,7 @@ SIA _EnumKey(E e) -> QString { return EnumInfo<E>::key(e); }
 
 RootMenu::RootMenu()
     : Menu(u"menu"_q, 0), d(new Data) {
+    StartupTracer::Scope trace("RootMenu");
 
     Q_UNUSED(QT_TR_NOOP("Toggle")); // dummy to tranlsate
 
@@ -365,6 +367,7 @@ RootMenu::RootMenu()
             d->action(u"quick"_q, QT_TR_NOOP("Quick Snapshot"));
             d->action(u"quick-nosub"_q, QT_TR_NOOP("Quick Snapshot(No Subtitles)"));
             d->action(u"tool"_q, QT_TR_NOOP("Snapshot Tool"));
+            d->action(u"range"_q, QT_TR_NOOP("Export Frames in Range"));
         });
         d->menu(u"clip"_q, QT_TR_NOOP("Make Video Clip"), [=] () {
             d->actionToGroup(u"range"_q, QT_TR_NOOP("Set Range to Current Time"))->setData(int('r'));
@@ -580,6 +583,9 @@ RootMenu::RootMenu()
             d->separator();
             d->actionToGroup(u"prev"_q, QT_TR_NOOP("Bring Previous Lines"), false, u"bring"_q)->setData(-1);
             d->actionToGroup(u"next"_q, QT_TR_NOOP("Bring Next Lines"), false, u"bring"_q)->setData(1);
+            d->separator();
+            d->action(u"anchor"_q, QT_TR_NOOP("Anchor Current Line to Now"));
+            d->action(u"clear-anchors"_q, QT_TR_NOOP("Clear Anchors"));
         });
     });
 
@@ -1,9 +1,11 @@
 #include "skin.hpp"
 #include "dialog/mbox.hpp"
 #include "misc/log.hpp"
+#include "misc/startuptracer.hpp"
 #include "configure.hpp"
 #include <QQuickView>
 #include <QQmlEngine>
+#include <QQmlComponent>
 
 DECLARE_LOG_CONTEXT(Skin)
 
@@ -51,15 +53,21 @@ auto Skin::names(bool reload/* = false*/) -> QStringList
     return d->skins.keys();
 }
 
-auto Skin::apply(QQuickView *view, const QString &name) -> void
+auto Skin::prepare(QQmlEngine *engine) -> void
 {
     if (data()->skins.isEmpty())
         names(true);
-    auto imports = view->engine()->importPathList();
+    auto imports = engine->importPathList();
     for (auto path : data()->qmls) {
         if (!imports.contains(path))
-            view->engine()->addImportPath(path);
+            engine->addImportPath(path);
     }
+}
+
+auto Skin::apply(QQuickView *view, const QString &name) -> void
+{
+    StartupTracer::Scope trace("Skin::apply");
+    prepare(view->engine());
     const auto skin = Skin::source(name);
     view->setResizeMode(QQuickView::SizeRootObjectToView);
     const auto current = QDir::currentPath();
@@ -68,6 +76,62 @@ auto Skin::apply(QQuickView *view, const QString &name) -> void
     QDir::setCurrent(current);
 }
 
+auto Skin::check(QQmlEngine *engine) -> int
+{
+    prepare(engine);
+    const auto current = QDir::currentPath();
+    QDir::setCurrent(qApp->applicationDirPath());
+    struct Cost { qint64 compile = 0, create = 0; bool ok = false; };
+    auto load = [&] (const QString &name, Cost &cost) -> QObject*
+    {
+        const auto url = QUrl::fromLocalFile(source(name).absoluteFilePath());
+        QElapsedTimer timer;
+        timer.start();
+        QQmlComponent component(engine, url);
+        cost.compile = timer.nsecsElapsed() / 1000;
+        auto object = component.isReady() ? component.create() : nullptr;
+        cost.create = timer.nsecsElapsed() / 1000 - cost.compile;
+        cost.ok = object;
+        if (!object) {
+            for (auto &error : component.errors())
+                _Error("%%: %%", name, error.toString());
+        }
+        return object;
+    };
+
+    const auto names = data()->skins.keys();
+    QMap<QString, Cost> cold, warm;
+    // nothing cached as on startup
+    for (auto &name : names) {
+        engine->clearComponentCache();
+        delete load(name, cold[name]);
+    }
+    // cache kept across skins as on switching, so that shared ones are reused
+    engine->clearComponentCache();
+    QObject *prev = nullptr;
+    for (auto &name : names) {
+        auto object = load(name, warm[name]);
+        delete prev;
+        engine->trimComponentCache();
+        prev = object;
+    }
+    delete prev;
+    engine->clearComponentCache();
+    QDir::setCurrent(current);
+
+    int failed = 0;
+    for (auto &name : names) {
+        const auto &c = cold[name], &w = warm[name];
+        if (!c.ok || !w.ok)
+            ++failed;
+        qDebug().nospace() << name.toLocal8Bit().constData()
+                           << ": startup " << c.compile * 1e-3 << "+" << c.create * 1e-3
+                           << "ms, switch " << w.compile * 1e-3 << "+" << w.create * 1e-3
+                           << "ms (compile+create)";
+    }
+    return failed;
+}
+
 auto Skin::source(const QString &name) -> QFileInfo
 {
     auto it = data()->skins.find(name);
@@ -2,6 +2,7 @@
 #define SKIN_HPP
 
 class QQuickView;
+class QQmlEngine;
 
 class Skin {
 public:
@@ -10,9 +11,13 @@ public:
     static auto names(bool reload = false) -> QStringList;
     static auto source(const QString &name) -> QFileInfo;
     static auto apply(QQuickView *view, const QString &name) -> void;
+    // loads every skin from scratch and as switching from another one
+    // and prints compilation and creation cost; returns number of failures
+    static auto check(QQmlEngine *engine) -> int;
 protected:
     Skin() {}
 private:
+    static auto prepare(QQmlEngine *engine) -> void;
     struct Data {
         Data();
         QStringList dirs, qmls;
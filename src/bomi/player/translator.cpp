@@ -111,7 +111,7 @@ auto Translator::load(const Locale &locale) -> bool
         d->tryLoad(&d->qt, "qt_"_a % l.name());
         Locale::setNative(l);
     } else
-        _Warn("Failed to load translation file: %%", file, d->def);
+        _Warn("Failed to load translation file: %% (%%)", file, d->def);
     return d->succ;
 }
 
@@ -75,6 +75,7 @@ private:
     P0(bool, remember_stopped, true)
     P0(bool, resume_ignore_in_playlist, false)
     P0(bool, precise_seeking, false)
+    P0(bool, analyze_video, false)
     P0(bool, remember_image, false)
     P0(bool, enable_generate_playlist, true)
     P0(QStringList, restore_properties, defaultRestoreProperties())
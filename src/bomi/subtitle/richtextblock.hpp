@@ -22,6 +22,8 @@ struct RichTextBlock {
             for (auto it = style.begin(); it != style.end(); ++it)
                 this->style[it.key()] = it.value();
         }
+        auto operator == (const Format &rhs) const -> bool
+            { return begin == rhs.begin && end == rhs.end && style == rhs.style; }
         Style style;
         int begin, end;
     };
@@ -34,6 +36,9 @@ struct RichTextBlock {
         }
         return false;
     }
+    auto operator == (const RichTextBlock &rhs) const -> bool;
+    auto operator != (const RichTextBlock &rhs) const -> bool
+        { return !operator == (rhs); }
     QVector<Format> formats;
     QString text;
     bool paragraph;
@@ -41,10 +46,21 @@ struct RichTextBlock {
 };
 
 struct RichTextBlock::Ruby {
+    auto operator == (const Ruby &rhs) const -> bool
+    {
+        return rb_begin == rhs.rb_begin && rb_end == rhs.rb_end
+                && rt_block == rhs.rt_block;
+    }
     int rb_begin = -1, rb_end = -1;
     RichTextBlock rt_block;
 };
 
+inline auto RichTextBlock::operator == (const RichTextBlock &rhs) const -> bool
+{
+    return paragraph == rhs.paragraph && text == rhs.text
+            && formats == rhs.formats && rubies == rhs.rubies;
+}
+
 class RichTextBlockParser : public RichTextHelper {
 public:
     RichTextBlockParser(const QStringRef &text);
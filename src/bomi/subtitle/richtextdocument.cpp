@@ -1,4 +1,5 @@
 #include "richtextdocument.hpp"
+#include <QRawFont>
 
 RichTextDocument::RichTextDocument()
 {
@@ -297,6 +298,79 @@ auto RichTextDocument::draw(QPainter *painter, const QPointF &pos) -> void
     }
 }
 
+auto RichTextDocument::drawOutline(QPainter *painter, const QPointF &pos,
+                                   const QPen &pen) -> void
+{
+    if (pen.style() == Qt::NoPen)
+        return;
+    QPainterPath path;
+    path.setFillRule(Qt::WindingFill);
+    for (const auto &glyphs : glyphRuns()) {
+        const auto &run = glyphs.run;
+        const auto font = run.rawFont();
+        const auto indexes = run.glyphIndexes();
+        const auto positions = run.positions();
+        for (int i = 0; i < indexes.size(); ++i)
+            path.addPath(font.pathForGlyph(indexes[i]).translated(positions[i]));
+        for (const auto &rect : decorations(run))
+            path.addRect(rect);
+    }
+    painter->save();
+    painter->translate(pos);
+    painter->strokePath(path, pen);
+    painter->restore();
+}
+
+auto RichTextDocument::glyphRuns() const -> QVector<GlyphRun>
+{
+    QVector<GlyphRun> runs;
+    const auto color = m_format.foreground().color();
+    auto add = [&runs] (const QTextLayout *layout, int from, int to,
+                        const QColor &color) {
+        if (from < to) {
+            for (const auto &run : layout->glyphRuns(from, to - from))
+                runs.push_back({run, color});
+        }
+    };
+    auto addLayout = [&] (const QTextLayout *layout) {
+        int pos = 0;
+        for (const auto &range : layout->additionalFormats()) {
+            const int end = range.start + range.length;
+            add(layout, pos, range.start, color);
+            add(layout, qMax(pos, range.start), end,
+                range.format.foreground().color());
+            pos = qMax(pos, end);
+        }
+        add(layout, pos, layout->text().size(), color);
+    };
+    for (auto layout : m_layouts) {
+        addLayout(&layout->block);
+        for (auto ruby : layout->rubies)
+            addLayout(ruby);
+    }
+    return runs;
+}
+
+auto RichTextDocument::decorations(const QGlyphRun &run) -> QVector<QRectF>
+{
+    QVector<QRectF> rects;
+    const auto positions = run.positions();
+    if (positions.isEmpty())
+        return rects;
+    const auto font = run.rawFont();
+    const auto box = run.boundingRect();
+    const auto y = positions.first().y();
+    auto line = [&] (qreal top)
+        { rects.push_back({box.left(), top, box.width(), font.lineThickness()}); };
+    if (run.underline())
+        line(y + font.underlinePosition());
+    if (run.strikeOut())
+        line(y - font.ascent()/3.0);
+    if (run.overline())
+        line(y - font.ascent());
+    return rects;
+}
+
 auto RichTextDocument::drawBoudingBoxes(QPainter *painter,
                                         const QPointF &pos) -> void
 {
@@ -2,11 +2,16 @@
 #define RICHTEXTDOCUMENT_HPP
 
 #include "richtextblock.hpp"
+#include <QGlyphRun>
 #include "richtexthelper.hpp"
 #include <QTextLayout>
 
 class RichTextDocument : public RichTextHelper {
 public:
+    struct GlyphRun {
+        QGlyphRun run;
+        QColor color;
+    };
     RichTextDocument();
     RichTextDocument(const QString &text);
     RichTextDocument(const RichTextDocument &rhs);
@@ -40,6 +45,13 @@ public:
     auto setWrapMode(QTextOption::WrapMode wrapMode) -> void;
     auto setFormat(QTextFormat::Property property, const QVariant &data) -> void;
     auto draw(QPainter *painter, const QPointF &pos) -> void;
+    // strokes glyphs of current layout without shaping text again
+    auto drawOutline(QPainter *painter, const QPointF &pos,
+                     const QPen &pen) -> void;
+    // glyphs of current layout with foreground color of each format range
+    auto glyphRuns() const -> QVector<GlyphRun>;
+    // underline, strike-out and overline of run
+    static auto decorations(const QGlyphRun &run) -> QVector<QRectF>;
     auto drawBoudingBoxes(QPainter *painter, const QPointF &pos) -> void;
     auto doLayout(double maxWidth) -> void;
     auto updateLayoutInfo() -> void;
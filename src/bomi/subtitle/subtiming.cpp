@@ -0,0 +1,68 @@
+#include "subtiming.hpp"
+
+auto SubTiming::isIdentity() const -> bool
+{
+    for (const auto &anchor : m_anchors) {
+        if (anchor.from != anchor.to)
+            return false;
+    }
+    return !m_offset;
+}
+
+auto SubTiming::setAnchors(const QVector<Anchor> &anchors) -> void
+{
+    m_anchors = anchors;
+    std::sort(m_anchors.begin(), m_anchors.end(),
+              [] (const Anchor &lhs, const Anchor &rhs)
+                  { return lhs.from < rhs.from; });
+    // both sides should increase strictly to be invertible
+    int last = 0;
+    for (int i = 0; i < m_anchors.size(); ++i) {
+        if (last > 0 && (m_anchors[i].from <= m_anchors[last - 1].from
+                         || m_anchors[i].to <= m_anchors[last - 1].to))
+            continue;
+        m_anchors[last++] = m_anchors[i];
+    }
+    m_anchors.resize(last);
+}
+
+auto SubTiming::addAnchor(int from, int to) -> void
+{
+    auto anchors = m_anchors;
+    for (int i = 0; i < anchors.size(); ++i) {
+        if (anchors[i].from == from)
+            anchors.remove(i--);
+    }
+    anchors.push_back({from, to});
+    setAnchors(anchors);
+}
+
+template<int SubTiming::Anchor::*x, int SubTiming::Anchor::*y>
+auto SubTiming::interpolate(int time) const -> int
+{
+    if (m_anchors.isEmpty())
+        return time;
+    if (m_anchors.size() == 1)
+        return time - m_anchors[0].*x + m_anchors[0].*y;
+    auto it = std::upper_bound(m_anchors.begin(), m_anchors.end(), time,
+                               [] (int t, const Anchor &anchor)
+                                   { return t < anchor.*x; });
+    // extrapolate by first or last segment
+    if (it == m_anchors.begin())
+        ++it;
+    else if (it == m_anchors.end())
+        --it;
+    const auto &a = *(it - 1), &b = *it;
+    const double slope = double(b.*y - a.*y)/(b.*x - a.*x);
+    return a.*y + qRound((time - a.*x) * slope);
+}
+
+auto SubTiming::map(int time) const -> int
+{
+    return interpolate<&Anchor::from, &Anchor::to>(time) + m_offset;
+}
+
+auto SubTiming::unmap(int time) const -> int
+{
+    return interpolate<&Anchor::to, &Anchor::from>(time - m_offset);
+}
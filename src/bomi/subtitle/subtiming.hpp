@@ -0,0 +1,41 @@
+#ifndef SUBTIMING_HPP
+#define SUBTIMING_HPP
+
+// maps time of subtitle file to time of playback in milliseconds
+// by piecewise linear function through anchors and global offset
+// one anchor shifts, two anchors correct linear drift and more anchors
+// give per-segment mapping; outer segments are extrapolated
+
+class SubTiming {
+public:
+    struct Anchor {
+        Anchor() { }
+        Anchor(int from, int to): from(from), to(to) { }
+        auto operator == (const Anchor &rhs) const -> bool
+            { return from == rhs.from && to == rhs.to; }
+        int from = 0, to = 0; // subtitle time -> playback time
+    };
+    auto operator == (const SubTiming &rhs) const -> bool
+        { return m_offset == rhs.m_offset && m_anchors == rhs.m_anchors; }
+    auto operator != (const SubTiming &rhs) const -> bool
+        { return !operator == (rhs); }
+    auto isIdentity() const -> bool;
+    auto offset() const -> int { return m_offset; }
+    auto setOffset(int ms) -> void { m_offset = ms; }
+    auto anchors() const -> const QVector<Anchor>& { return m_anchors; }
+    // anchors which break monotonicity are dropped
+    auto setAnchors(const QVector<Anchor> &anchors) -> void;
+    auto addAnchor(int from, int to) -> void;
+    auto clear() -> void { m_offset = 0; m_anchors.clear(); }
+    // subtitle time -> playback time
+    auto map(int time) const -> int;
+    // playback time -> subtitle time
+    auto unmap(int time) const -> int;
+private:
+    template<int Anchor::*x, int Anchor::*y>
+    auto interpolate(int time) const -> int;
+    int m_offset = 0;
+    QVector<Anchor> m_anchors;
+};
+
+#endif // SUBTIMING_HPP
@@ -46,12 +46,73 @@ auto SubtitleDrawer::setStyle(const OsdStyle &style) -> void
 {
     m_style = style;
     updateStyle(m_front, style);
-    updateStyle(m_back, style);
     if (style.outline.enabled) {
         const auto size = style.font.height()*style.outline.width*2.0;
-        m_back.setTextOutline(style.outline.color, size);
+        m_outline = QPen(style.outline.color, size);
     } else
-        m_back.setTextOutline(Qt::NoPen);
+        m_outline = QPen(Qt::NoPen);
+    m_cache.clear();
+}
+
+auto SubtitleDrawer::layout(const RichTextDocument &text,
+                            double width) -> RichTextDocument&
+{
+    auto &layouts = m_cache.layouts;
+    for (auto it = layouts.begin(); it != layouts.end(); ++it) {
+        if (it->width == width && it->blocks == text.blocks()) {
+            layouts.splice(layouts.begin(), layouts, it);
+            return layouts.front().doc;
+        }
+    }
+    if (layouts.size() >= MaxLayouts)
+        layouts.pop_back();
+    layouts.emplace_front();
+    auto &layout = layouts.front();
+    layout.blocks = text.blocks();
+    layout.width = width;
+    layout.doc = m_front;
+    layout.doc += text;
+    layout.doc.updateLayoutInfo();
+    layout.doc.doLayout(width);
+    return layout.doc;
+}
+
+// scratch image on buffer which grows by buckets and is reused for every draw
+auto SubtitleDrawer::layer(const QSize &size, double dpr) -> QImage
+{
+    const int w = (size.width() + Bucket - 1)/Bucket*Bucket;
+    const int h = (size.height() + Bucket - 1)/Bucket*Bucket;
+    auto &buffer = m_cache.buffer;
+    if (buffer.size() < w*h*4)
+        buffer.resize(w*h*4);
+    QImage image((uchar*)buffer.data(), size.width(), size.height(), w*4,
+                 QImage::Format_ARGB32_Premultiplied);
+    image.setDevicePixelRatio(dpr);
+    return image;
+}
+
+auto SubtitleDrawer::frame(const RichTextDocument &doc, const QRectF &area,
+                           double dpr) const -> Frame
+{
+    Frame f;
+    f.scale = this->scale(area)*dpr;
+    const double fscale = m_style.font.height()*f.scale;
+    if (m_style.bbox.enabled)
+        f.thick = (fscale*m_style.bbox.padding).toPoint();
+    if (m_style.shadow.enabled)
+        f.shadow = (fscale*m_style.shadow.offset).toPoint();
+    f.blur = m_style.shadow.blur ? qRound(fscale*0.01) : 0;
+    const auto nsize = doc.naturalSize()*f.scale;
+    f.size = QSize(nsize.width() + 1, nsize.height() + 1);
+    // text moves by negative shadow offset to keep shadow in image
+    const QPoint pad(qAbs(f.shadow.x()), qAbs(f.shadow.y()));
+    QPoint offset(qMax(0, -f.shadow.x()), qMax(0, -f.shadow.y()));
+    f.size += {pad.x() + (f.blur+f.thick.x())*2,
+               pad.y() + (f.blur+f.thick.y())*2};
+    offset += QPoint(f.blur, f.blur) + f.thick;
+    const auto x = -(area.width() * dpr - nsize.width()) * 0.5 + offset.x();
+    f.origin = QPointF(x, offset.y());
+    return f;
 }
 
 auto SubtitleDrawer::draw(QImage &image, int &gap, const RichTextDocument &text,
@@ -62,67 +123,45 @@ auto SubtitleDrawer::draw(QImage &image, int &gap, const RichTextDocument &text,
     if (!(m_drawn = text.hasWords()))
         return bboxes;
     const double scale = this->scale(area)*dpr;
-    const double fscale = m_style.font.height()*scale;
-    auto make = [=] (RichTextDocument &doc, const RichTextDocument &from) {
-        doc = from;
-        doc += text;
-        doc.updateLayoutInfo();
-        doc.doLayout(area.width()/(scale/dpr));
-    };
-    RichTextDocument front, back;
-    make(front, m_front);
-    make(back, m_back);
-    QPoint thick(0, 0);
-    if (m_style.bbox.enabled)
-        thick = (fscale*m_style.bbox.padding).toPoint();
-    QPoint soffset(0, 0);
-    if (m_style.shadow.enabled)
-        soffset = (fscale*m_style.shadow.offset).toPoint();
-    QPoint offset(0, 0);
-    const int blur = m_style.shadow.blur ? qRound(fscale*0.01) : 0;
-    const auto nsize = front.naturalSize()*scale;
-    QSize imageSize(nsize.width() + 1, nsize.height() + 1);
-    QPoint pad = soffset;
-    if (soffset.x() < 0) {
-        pad.rx() = offset.rx() = -soffset.x();
-        soffset.rx() = 0;
-    }
-    if (soffset.y() < 0) {
-        pad.ry() = offset.ry() = -soffset.y();
-        soffset.ry() = 0;
-    }
-    imageSize += {pad.rx() + (blur+thick.x())*2, pad.ry() + (blur+thick.y())*2};
-    const QPoint pblur(blur, blur);
-    offset += pblur;
-    offset += thick;
-    image = QImage(imageSize, QImage::Format_ARGB32_Premultiplied);
+    auto &front = layout(text, area.width()/(scale/dpr));
+    const auto f = frame(front, area, dpr);
+    const auto imageSize = f.size;
+    const auto origin = f.origin;
+    const auto thick = f.thick;
+    // redraw in place if previous image is not referenced elsewhere
+    if (image.size() != imageSize || !image.isDetached()
+            || image.format() != QImage::Format_ARGB32_Premultiplied)
+        image = QImage(imageSize, QImage::Format_ARGB32_Premultiplied);
     if (!image.isNull()) {
-        const auto x = -(area.width() * dpr - nsize.width()) * 0.5 + offset.x();
-        QPointF origin(x, offset.y());
         image.setDevicePixelRatio(dpr);
-        image.fill(0x0);
-        QPainter painter(&image);
+        // text is drawn on scratch layer when shadow goes under it
+        QImage scratch;
+        if (m_style.shadow.enabled)
+            scratch = layer(imageSize, dpr);
+        auto &canvas = m_style.shadow.enabled ? scratch : image;
+        canvas.fill(0x0);
+        QPainter painter(&canvas);
         painter.translate(origin/dpr);
         painter.scale(scale/dpr, scale/dpr);
-        back.draw(&painter, QPointF(0, 0));
+        front.drawOutline(&painter, QPointF(0, 0), m_outline);
         front.draw(&painter, QPointF(0, 0));
         painter.end();
         if (m_style.shadow.enabled) {
-            QImage bg(image.size(), QImage::Format_ARGB32_Premultiplied);
-            bg.setDevicePixelRatio(dpr);
-            auto dest = bg.bits();
+            // shadow offset is clipped to non-negative for drawing image
+            const QPoint soffset(qMax(0, f.shadow.x()), qMax(0, f.shadow.y()));
+            auto dest = image.bits();
             const quint32 sr = m_style.shadow.color.red();
             const quint32 sg = m_style.shadow.color.green();
             const quint32 sb = m_style.shadow.color.blue();
             const quint32 sa = m_style.shadow.color.alpha();
-            for (int y=0; y<bg.height(); ++y) {
+            for (int y=0; y<image.height(); ++y) {
                 const int ys = y - soffset.y();
                 if (ys < 0) {
-                    memset(dest, 0, bg.bytesPerLine());
-                    dest += bg.bytesPerLine();
+                    memset(dest, 0, image.bytesPerLine());
+                    dest += image.bytesPerLine();
                 } else {
-                    auto src = image.bits() + image.bytesPerLine() * ys;
-                    for (int x=0; x<bg.width(); ++x) {
+                    auto src = canvas.constBits() + canvas.bytesPerLine() * ys;
+                    for (int x=0; x<image.width(); ++x) {
                         const int xs = x-soffset.x();
                         if (xs < 0) {
                             *dest++ = 0;
@@ -139,12 +178,11 @@ auto SubtitleDrawer::draw(QImage &image, int &gap, const RichTextDocument &text,
                     }
                 }
             }
-            if (blur)
-                m_blur.applyTo(bg, m_style.shadow.color, blur);
-            painter.begin(&bg);
-            painter.drawImage(QPoint(0, 0), image);
+            if (f.blur)
+                m_blur.applyTo(image, m_style.shadow.color, f.blur);
+            painter.begin(&image);
+            painter.drawImage(QPoint(0, 0), canvas);
             painter.end();
-            image.swap(bg);
         }
         if (m_style.bbox.enabled) {
             bboxes = front.boundingBoxes();
@@ -161,3 +199,61 @@ auto SubtitleDrawer::draw(QImage &image, int &gap, const RichTextDocument &text,
     }
     return bboxes;
 }
+
+auto SubtitleDrawer::draw(QVector<SubGlyphQuad> &quads, QSize &extent,
+                          const RichTextDocument &text, const QRectF &area,
+                          double dpr) -> void
+{
+    quads.clear();
+    extent = {0, 0};
+    if (!(m_drawn = text.hasWords()))
+        return;
+    const double scale = this->scale(area)*dpr;
+    auto &front = layout(text, area.width()/(scale/dpr));
+    const auto f = frame(front, area, dpr);
+    extent = f.size;
+    const bool outlined = m_outline.style() != Qt::NoPen;
+    const double outline = outlined ? m_outline.widthF()*f.scale : 0.0;
+    const auto stroke = qPremultiply(m_outline.color().rgba());
+    const auto shadow = qPremultiply(m_style.shadow.color.rgba());
+    // shadows go under outlines which go under fills as rasterized
+    QVector<SubGlyphQuad> shadows, outlines, fills;
+    auto push = [&] (const SubGlyphPtr &fill, const SubGlyphPtr &back,
+                     const QRect &rect, const QRect &backRect, QRgb color) {
+        fills.push_back({fill, rect, color});
+        if (outlined)
+            outlines.push_back({back, backRect, stroke});
+        if (m_style.shadow.enabled)
+            shadows.push_back({back, backRect.translated(f.shadow), shadow});
+    };
+    for (const auto &glyphs : front.glyphRuns()) {
+        const auto &run = glyphs.run;
+        const auto color = qPremultiply(glyphs.color.rgba());
+        auto font = run.rawFont();
+        font.setPixelSize(font.pixelSize()*f.scale);
+        const auto indexes = run.glyphIndexes();
+        const auto positions = run.positions();
+        for (int i = 0; i < indexes.size(); ++i) {
+            const auto fill = SubGlyphCache::get(font, indexes[i], 0.0);
+            if (!fill)
+                continue;
+            auto back = fill;
+            if (outlined)
+                back = SubGlyphCache::get(font, indexes[i], outline);
+            const auto pos = (positions[i]*f.scale + f.origin).toPoint();
+            push(fill, back, {pos + fill->offset, fill->image.size()},
+                 {pos + back->offset, back->image.size()}, color);
+        }
+        for (const auto &deco : RichTextDocument::decorations(run)) {
+            const QRectF rect(deco.topLeft()*f.scale + f.origin,
+                              deco.size()*f.scale);
+            const auto d = outline*0.5;
+            push(SubGlyphPtr(), SubGlyphPtr(), rect.toAlignedRect(),
+                 rect.adjusted(-d, -d, d, d).toAlignedRect(), color);
+        }
+    }
+    quads.reserve(shadows.size() + outlines.size() + fills.size());
+    quads += shadows;
+    quads += outlines;
+    quads += fills;
+}
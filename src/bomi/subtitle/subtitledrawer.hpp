@@ -3,6 +3,8 @@
 
 #include "misc/osdstyle.hpp"
 #include "subtitle.hpp"
+#include "subtitleglyphs.hpp"
+#include <list>
 
 struct Margin {
     Margin() {}
@@ -121,12 +123,19 @@ public:
     auto creator() const -> void* { return m_creator; }
     auto boundingBoxes() const -> const QVector<QRectF>& { return m_bboxes; }
     auto gap() const -> int { return m_gap; }
+    // quads to draw from glyph atlas instead of image
+    auto glyphs() const -> const QVector<SubGlyphQuad>& { return m_glyphs; }
+    auto hasGlyphs() const -> bool { return !m_glyphs.isEmpty(); }
+    // size of image or glyph quads in pixels
+    auto extent() const -> QSize { return hasGlyphs() ? m_extent : size(); }
 private:
     friend class SubtitleDrawer;
     const SubComp *m_comp = nullptr;
     Iterator m_it;
     RichTextDocument m_text;
     QVector<QRectF> m_bboxes;
+    QVector<SubGlyphQuad> m_glyphs;
+    QSize m_extent{0, 0};
     int m_gap = 0;
     void *m_creator = nullptr;
 };
@@ -139,7 +148,15 @@ public:
     auto hasDrawn() const -> bool {return m_drawn;}
     auto draw(QImage &image, int &gap, const RichTextDocument &text,
               const QRectF &area, double dpr = 1.0) -> QVector<QRectF>;
+    // lays out glyph quads instead of rasterizing whole text
+    auto draw(QVector<SubGlyphQuad> &quads, QSize &extent,
+              const RichTextDocument &text, const QRectF &area,
+              double dpr = 1.0) -> void;
     auto draw(SubCompImage &pic, const QRectF &area, double dpr = 1.0) -> bool;
+    auto setGlyphAtlas(bool on) -> void { m_glyphAtlas = on; }
+    auto isGlyphAtlas() const -> bool { return m_glyphAtlas; }
+    // bounding boxes and blurred shadow are drawn only by rasterizing
+    auto canUseGlyphs() const -> bool;
     auto pos(const QSizeF &image, const QRectF &area) const -> QPointF;
     auto alignment() const -> Qt::Alignment { return m_alignment; }
     auto margin() const -> const Margin& { return m_margin; }
@@ -148,24 +165,64 @@ public:
 private:
     static auto updateStyle(RichTextDocument &doc,
                             const OsdStyle &style) -> void;
+    // returns shaped layout for text, shared by outline and fill
+    auto layout(const RichTextDocument &text,
+                double width) -> RichTextDocument&;
+    auto layer(const QSize &size, double dpr) -> QImage;
+    struct Frame {
+        double scale = 1.0;
+        QSize size;
+        QPointF origin;
+        QPoint shadow, thick;
+        int blur = 0;
+    };
+    auto frame(const RichTextDocument &doc, const QRectF &area,
+               double dpr) const -> Frame;
+    static constexpr int MaxLayouts = 8;
+    static constexpr int Bucket = 64;
+    struct Layout {
+        QList<RichTextBlock> blocks;
+        double width = 0.0;
+        RichTextDocument doc;
+    };
+    // not shared between copies which may live in other threads
+    struct Cache {
+        Cache() { }
+        Cache(const Cache &) { }
+        auto operator = (const Cache &) -> Cache& { clear(); return *this; }
+        auto clear() -> void { layouts.clear(); }
+        std::list<Layout> layouts;
+        QByteArray buffer;
+    };
     OsdStyle m_style;
-    RichTextDocument m_front, m_back;
+    RichTextDocument m_front;
+    QPen m_outline{Qt::NoPen};
     Margin m_margin;
     Qt::Alignment m_alignment;
-    bool m_drawn = false;
+    bool m_drawn = false, m_glyphAtlas = false;
     FastAlphaBlur m_blur;
-    QByteArray m_buffer;
+    Cache m_cache;
 };
 
 inline auto SubtitleDrawer::setAlignment(Qt::Alignment alignment) -> void
 {
-    m_back.setAlignment(m_alignment = alignment);
-    m_front.setAlignment(alignment);
+    m_front.setAlignment(m_alignment = alignment);
+    m_cache.clear();
+}
+
+inline auto SubtitleDrawer::canUseGlyphs() const -> bool
+{
+    return m_glyphAtlas && !m_style.bbox.enabled
+            && !(m_style.shadow.enabled && m_style.shadow.blur);
 }
 
 inline auto SubtitleDrawer::draw(SubCompImage &pic, const QRectF &area,
                                  double dpr) -> bool
 {
+    if (canUseGlyphs()) {
+        draw(pic.m_glyphs, pic.m_extent, pic.m_text, area, dpr);
+        return pic.hasGlyphs();
+    }
     pic.m_bboxes = draw(pic, pic.m_gap, pic.m_text, area, dpr);
     return !pic.isNull();
 }
@@ -0,0 +1,73 @@
+#include "subtitleglyphs.hpp"
+#include <QRawFont>
+
+// plenty for a few fonts and sizes in use at once
+static constexpr int MaxGlyphs = 4096;
+
+struct GlyphKey {
+    QString family, style;
+    int weight = 0, italic = 0, px = 0, outline = 0;
+    quint32 index = 0;
+    auto operator == (const GlyphKey &rhs) const -> bool
+    {
+        return index == rhs.index && px == rhs.px && outline == rhs.outline
+                && weight == rhs.weight && italic == rhs.italic
+                && family == rhs.family && style == rhs.style;
+    }
+};
+
+SIA qHash(const GlyphKey &key, uint seed = 0) -> uint
+{
+    return qHash(key.family, seed) ^ qHash(key.style, seed)
+            ^ qHash(key.index, seed) ^ qHash(key.px << 8 ^ key.outline, seed)
+            ^ uint(key.weight << 1 | key.italic);
+}
+
+static QMutex s_mutex;
+static QHash<GlyphKey, SubGlyphPtr> s_glyphs;
+static QAtomicInt s_ids;
+
+auto SubGlyphCache::get(const QRawFont &font, quint32 index,
+                        double outline) -> SubGlyphPtr
+{
+    GlyphKey key;
+    key.family = font.familyName();
+    key.style = font.styleName();
+    key.weight = font.weight();
+    key.italic = font.style();
+    key.px = qRound(font.pixelSize() * 64);
+    key.outline = qRound(outline * 64);
+    key.index = index;
+    {
+        QMutexLocker locker(&s_mutex);
+        const auto it = s_glyphs.constFind(key);
+        if (it != s_glyphs.cend())
+            return *it;
+    }
+    // rasterize without lock; racing threads produce same image
+    SubGlyphPtr glyph;
+    const auto path = font.pathForGlyph(index);
+    if (!path.isEmpty()) {
+        const auto pad = outline * 0.5 + 1.0;
+        const auto rect = path.boundingRect()
+                .adjusted(-pad, -pad, pad, pad).toAlignedRect();
+        auto g = new SubGlyph;
+        g->id = s_ids.fetchAndAddRelaxed(1) + 1;
+        g->offset = rect.topLeft();
+        g->image = QImage(rect.size(), QImage::Format_ARGB32_Premultiplied);
+        g->image.fill(0x0);
+        QPainter painter(&g->image);
+        painter.setRenderHint(QPainter::Antialiasing);
+        painter.translate(-rect.topLeft());
+        painter.fillPath(path, Qt::white);
+        if (outline > 0.0)
+            painter.strokePath(path, QPen(Qt::white, outline));
+        painter.end();
+        glyph.reset(g);
+    }
+    QMutexLocker locker(&s_mutex);
+    if (s_glyphs.size() >= MaxGlyphs)
+        s_glyphs.clear();
+    s_glyphs.insert(key, glyph);
+    return glyph;
+}
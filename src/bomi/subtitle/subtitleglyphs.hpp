@@ -0,0 +1,31 @@
+#ifndef SUBTITLEGLYPHS_HPP
+#define SUBTITLEGLYPHS_HPP
+
+class QRawFont;
+
+// glyph rasterized once and shared by captions of all threads
+// image is white premultiplied ARGB so that its alpha holds coverage
+struct SubGlyph {
+    int id = 0;
+    QPoint offset; // from pen position to top-left of image
+    QImage image;
+};
+
+using SubGlyphPtr = QSharedPointer<const SubGlyph>;
+
+// quad in pixels of caption image; null glyph means solid rect
+struct SubGlyphQuad {
+    SubGlyphPtr glyph;
+    QRect rect;
+    QRgb color = 0; // premultiplied
+};
+
+class SubGlyphCache {
+public:
+    // thread-safe; returns null for blank glyph
+    // outline > 0 dilates glyph by outline width in pixels
+    static auto get(const QRawFont &font, quint32 index,
+                    double outline) -> SubGlyphPtr;
+};
+
+#endif // SUBTITLEGLYPHS_HPP
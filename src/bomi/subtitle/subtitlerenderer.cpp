@@ -5,9 +5,65 @@
 #include "opengl/opengltexture2d.hpp"
 #include "opengl/opengltexturebinder.hpp"
 
+DECLARE_LOG_CONTEXT(Subtitle)
+
+// shelf-packed texture of glyphs which are uploaded on demand
+// all methods should be called in GL thread
+class SubGlyphAtlas {
+public:
+    static constexpr int Size = 2048;
+    auto create() -> void
+    {
+        m_texture.create();
+        OpenGLTextureBinder<OGL::Target2D> binder(&m_texture);
+        // zero gaps between glyphs for linear filtering
+        m_texture.initialize(Size, Size, QVector<quint32>(Size*Size).data());
+        const QVector<quint32> white(Solid*Solid, _Max<quint32>());
+        m_texture.upload(0, 0, Solid, Solid, white.data());
+        clear();
+    }
+    auto destroy() -> void { m_texture.destroy(); m_rects.clear(); }
+    auto clear() -> void
+    {
+        m_rects.clear();
+        m_x = Solid + Gap; m_y = 0; m_row = Solid;
+    }
+    auto texture() const -> const OpenGLTexture2D& { return m_texture; }
+    // returns null rect if atlas is full
+    auto rect(const SubGlyph *glyph) -> QRect
+    {
+        const auto it = m_rects.constFind(glyph->id);
+        if (it != m_rects.cend())
+            return *it;
+        const auto size = glyph->image.size();
+        if (m_x + size.width() > Size) {
+            m_x = 0;
+            m_y += m_row + Gap;
+            m_row = 0;
+        }
+        if (m_x + size.width() > Size || m_y + size.height() > Size)
+            return QRect();
+        const QRect rect({m_x, m_y}, size);
+        OpenGLTextureBinder<OGL::Target2D> binder(&m_texture);
+        m_texture.upload(rect, glyph->image.constBits());
+        m_x += size.width() + Gap;
+        m_row = qMax(m_row, size.height());
+        m_rects.insert(glyph->id, rect);
+        return rect;
+    }
+    // inner texels of white block for solid rects
+    auto solid() const -> QRect { return {1, 1, Solid - 2, Solid - 2}; }
+private:
+    static constexpr int Solid = 4, Gap = 1;
+    QHash<int, QRect> m_rects;
+    int m_x = 0, m_y = 0, m_row = 0;
+    OpenGLTexture2D m_texture;
+};
+
 struct SubtitleShaderData : public SubtitleRenderer::ShaderData {
-    const OpenGLTexture2D *texture, *bbox;
+    const OpenGLTexture2D *texture, *bbox, *atlas;
     QColor bboxColor;
+    bool glyphs = false;
 };
 
 struct SubtitleShader : public SubtitleRenderer::ShaderIface {
@@ -17,9 +73,12 @@ struct SubtitleShader : public SubtitleRenderer::ShaderIface {
             uniform mat4 qt_Matrix;
             attribute vec4 aPosition;
             attribute vec2 aTexCoord;
+            attribute vec4 aColor;
             varying vec2 texCoord;
+            varying vec4 color;
             void main() {
                 texCoord = aTexCoord;
+                color = aColor;
                 gl_Position = qt_Matrix * aPosition;
             }
         )";
@@ -27,31 +86,39 @@ struct SubtitleShader : public SubtitleRenderer::ShaderIface {
             uniform sampler2D tex;
             uniform sampler2D bbox;
             uniform vec4 bboxColor;
+            uniform bool glyphs;
             varying vec2 texCoord;
+            varying vec4 color;
             void main() {
-                vec4 top = texture2D(tex, texCoord);
-                float alpha = texture2D(bbox, texCoord).a*bboxColor.a*(1.0 - top.a);
-                gl_FragColor = top + bboxColor*alpha;
+                if (glyphs) {
+                    gl_FragColor = color * texture2D(tex, texCoord).a;
+                } else {
+                    vec4 top = texture2D(tex, texCoord);
+                    float alpha = texture2D(bbox, texCoord).a*bboxColor.a*(1.0 - top.a);
+                    gl_FragColor = top + bboxColor*alpha;
+                }
             }
         )");
-        attributes << "aPosition" << "aTexCoord";
+        attributes << "aPosition" << "aTexCoord" << "aColor";
     }
     void resolve(QOpenGLShaderProgram *prog) override {
         loc_tex = prog->uniformLocation("tex");
         loc_bbox = prog->uniformLocation("bbox");
         loc_bboxColor = prog->uniformLocation("bboxColor");
+        loc_glyphs = prog->uniformLocation("glyphs");
     }
     void update(QOpenGLShaderProgram *prog,
                 SubtitleRenderer::ShaderData *data) override {
         auto d = static_cast<const SubtitleShaderData*>(data);
         auto f = func();
-        d->texture->bind(prog, loc_tex, 0);
+        (d->glyphs ? d->atlas : d->texture)->bind(prog, loc_tex, 0);
         d->bbox->bind(prog, loc_bbox, 1);
         prog->setUniformValue(loc_bboxColor, d->bboxColor);
+        prog->setUniformValue(loc_glyphs, (GLint)d->glyphs);
         f->glActiveTexture(GL_TEXTURE0);
     }
 private:
-    int loc_tex = -1, loc_bbox = -1, loc_bboxColor = -1;
+    int loc_tex = -1, loc_bbox = -1, loc_bboxColor = -1, loc_glyphs = -1;
 };
 
 struct SubtitleRenderer::Data {
@@ -74,7 +141,11 @@ struct SubtitleRenderer::Data {
     }
     QVector<quint32> zeros, bboxData;
     SubCompSelection selection{p};
-    OpenGLTexture2D bbox;
+    OpenGLTexture2D texture, bbox;
+    SubGlyphAtlas atlas;
+    // quads of glyphs in pixels of stacked captions
+    QVector<OGL::TextureColorVertex> glyphs;
+    bool glyphMode = false;
 
     auto find(int id) const -> SubComp*
     {
@@ -115,13 +186,19 @@ struct SubtitleRenderer::Data {
     void updateVisible() {
         p->setVisible(!hidden && !empty && !imageSize.isEmpty());
     }
+    // playback time of caption at key
+    int time(const SubComp &comp, int key) const {
+        return selection.timing().map(comp.toTime(key, fps()));
+    }
 };
 
 SubtitleRenderer::SubtitleRenderer(QQuickItem *parent)
-    : SimpleTextureItem(parent)
+    : Super(parent)
     , d(new Data(this))
 {
+    static const bool atlas = qgetenv("BOMI_SUBTITLE_GLYPH_ATLAS") == "1";
     d->drawer.setAlignment(Qt::AlignBottom | Qt::AlignHCenter);
+    d->drawer.setGlyphAtlas(atlas);
     d->updateDrawer();
 }
 
@@ -153,16 +230,19 @@ auto SubtitleRenderer::createShader() const -> ShaderIface*
 
 auto SubtitleRenderer::initializeGL() -> void
 {
-    SimpleTextureItem::initializeGL();
-    texture().create();
+    Super::initializeGL();
+    d->texture.create();
     d->bbox.create();
+    if (d->drawer.isGlyphAtlas())
+        d->atlas.create();
 }
 
 auto SubtitleRenderer::finalizeGL() -> void
 {
-    SimpleTextureItem::finalizeGL();
+    Super::finalizeGL();
+    d->atlas.destroy();
     d->bbox.destroy();
-    texture().destroy();
+    d->texture.destroy();
 }
 
 auto SubtitleRenderer::text() const -> const RichTextDocument&
@@ -262,6 +342,8 @@ auto SubtitleRenderer::style() const -> const OsdStyle&
 auto SubtitleRenderer::unload() -> void
 {
     d->selection.clear();
+    // retiming belongs to loaded files
+    d->selection.setTiming(SubTiming());
     qDeleteAll(d->loaded);
     d->loaded.clear();
     setVisible(false);
@@ -270,45 +352,76 @@ auto SubtitleRenderer::unload() -> void
     emit selectionChanged();
 }
 
+auto SubtitleRenderer::vertexCount() const -> int
+{
+    return d->glyphMode ? d->glyphs.size() : 6;
+}
+
 auto SubtitleRenderer::updateVertex(Vertex *vertex) -> void
 {
     const auto dpr = devicePixelRatio();
     const QRectF r(d->drawer. pos(d->imageSize/dpr, rect()), d->imageSize/dpr);
-    OGL::CoordAttr::fillTriangleStrip(vertex, &Vertex::position,
-                                      r.topLeft(), r.bottomRight());
+    if (d->glyphMode) {
+        for (const auto &v : d->glyphs) {
+            *vertex = v;
+            vertex->position.set(r.topLeft() + v.position.toPoint()/dpr);
+            ++vertex;
+        }
+    } else
+        OGL::CoordAttr::fillTriangles(vertex, &Vertex::position,
+                                      r.topLeft(), r.bottomRight(),
+                                      &Vertex::texCoord, {0, 0}, {1, 1},
+                                      [] (Vertex *v) { v->color.set(_Max<quint32>()); });
 }
 
 auto SubtitleRenderer::createData() const -> ShaderData*
 {
     auto data = new SubtitleShaderData;
-    data->texture = &texture();
+    data->texture = &d->texture;
     data->bbox = &d->bbox;
+    data->atlas = &d->atlas.texture();
     return data;
 }
 
 auto SubtitleRenderer::updateData(ShaderData *sd) -> void
 {
     auto data = static_cast<SubtitleShaderData*>(sd);
-    updateTexture(&texture());
+    updateTexture();
     data->bboxColor = d->drawer.style().bbox.color;
+    data->glyphs = d->glyphMode;
 }
 
-auto SubtitleRenderer::updateTexture(OpenGLTexture2D *texture) -> void
+auto SubtitleRenderer::updateTexture() -> void
 {
     d->imageSize = {0, 0};
     const int spacing = d->drawer.style().font.height()
             * d->drawer.scale(geometry())
             * d->drawer.style().spacing.paragraph + 0.5;
     int lastTime = -1;
+    bool glyphs = false;
     d->selection.forImages([&] (const SubCompImage &image) {
-        if (d->imageSize.width() < image.width())
-            d->imageSize.rwidth() = image.width();
-        d->imageSize.rheight() += image.height() + spacing;
+        const auto extent = image.extent();
+        if (d->imageSize.width() < extent.width())
+            d->imageSize.rwidth() = extent.width();
+        d->imageSize.rheight() += extent.height() + spacing;
         if (image.isValid())
             lastTime = std::max(image.iterator().key(), lastTime);
+        glyphs |= image.hasGlyphs();
     });
     d->imageSize.rheight() -= spacing;
-    if (!d->imageSize.isEmpty()) {
+    // images drawn before switching mode are skipped until rerendered
+    d->glyphMode = glyphs && d->atlas.texture().isValid();
+    if (d->glyphMode) {
+        if (!updateGlyphs()) {
+            _Warn("Glyph atlas is full. Fall back to rasterized subtitle.");
+            d->glyphs.clear();
+            d->drawer.setGlyphAtlas(false);
+            d->updateDrawer();
+            rerender();
+        }
+        reserve(UpdateGeometry, false);
+    } else if (!d->imageSize.isEmpty()) {
+        auto texture = &d->texture;
         const auto len = d->imageSize.width()*d->imageSize.height();
         _Expand(d->zeros, len);
         OpenGLTextureBinder<OGL::Target2D> binder;
@@ -330,7 +443,7 @@ auto SubtitleRenderer::updateTexture(OpenGLTexture2D *texture) -> void
                     d->bbox.upload(rect, d->bboxData.data());
                 }
             }
-            y += image.height() + spacing;
+            y += image.extent().height() + spacing;
         });
         reserve(UpdateGeometry, false);
     }
@@ -338,6 +451,54 @@ auto SubtitleRenderer::updateTexture(OpenGLTexture2D *texture) -> void
         emit updated(d->lastTime);
 }
 
+// only vertices are rebuilt for new captions; glyphs missing in atlas are
+// uploaded once and the atlas restarts when it runs out of space
+auto SubtitleRenderer::updateGlyphs() -> bool
+{
+    const int spacing = d->drawer.style().font.height()
+            * d->drawer.scale(geometry())
+            * d->drawer.style().spacing.paragraph + 0.5;
+    const double size = SubGlyphAtlas::Size;
+    auto build = [&] () -> bool {
+        d->glyphs.clear();
+        int y = 0;
+        bool ok = true;
+        d->selection.forImages([&] (const SubCompImage &image) {
+            if (!ok)
+                return;
+            const auto extent = image.extent();
+            const QPoint offset((d->imageSize.width() - extent.width())/2, y);
+            y += extent.height() + spacing;
+            for (const auto &quad : image.glyphs()) {
+                const auto tex = quad.glyph ? d->atlas.rect(quad.glyph.data())
+                                            : d->atlas.solid();
+                if (tex.isNull()) {
+                    ok = false;
+                    return;
+                }
+                const QRectF rect(quad.rect.translated(offset));
+                const QRectF coord(tex.x()/size, tex.y()/size,
+                                   tex.width()/size, tex.height()/size);
+                const int at = d->glyphs.size();
+                d->glyphs.resize(at + 6);
+                OGL::CoordAttr::fillTriangles(
+                    d->glyphs.begin() + at,
+                    &Vertex::position, rect.topLeft(), rect.bottomRight(),
+                    &Vertex::texCoord, coord.topLeft(), coord.bottomRight(),
+                    [&quad] (Vertex *v) {
+                        v->color.set(qRed(quad.color), qGreen(quad.color),
+                                     qBlue(quad.color), qAlpha(quad.color));
+                    });
+            }
+        });
+        return ok;
+    };
+    if (build())
+        return true;
+    d->atlas.clear();
+    return build();
+}
+
 auto SubtitleRenderer::afterUpdate() -> void
 {
     d->updateVisible();
@@ -351,7 +512,7 @@ auto SubtitleRenderer::isHidden() const -> bool
 auto SubtitleRenderer::geometryChanged(const QRectF &new_, const QRectF &old) -> void
 {
     d->selection.setArea(rect(), devicePixelRatio());
-    SimpleTextureItem::geometryChanged(new_, old);
+    Super::geometryChanged(new_, old);
 }
 
 auto SubtitleRenderer::delay() const -> int
@@ -375,6 +536,17 @@ auto _Change2(T &the, const T &one, bool(*equal)(U,U)) -> bool
     return _Change2(the, one, [equal] (const T &t1, const T &t2) { return equal(t1, t2); });
 }
 
+auto SubtitleRenderer::timing() const -> const SubTiming&
+{
+    return d->selection.timing();
+}
+
+auto SubtitleRenderer::setTiming(const SubTiming &timing) -> void
+{
+    d->selection.setTiming(timing);
+    rerender();
+}
+
 auto SubtitleRenderer::setPos(double pos) -> void
 {
     if (_Change2<double>(d->pos, qBound(0.0, pos, 1.0), qFuzzyCompare))
@@ -458,10 +630,11 @@ auto SubtitleRenderer::lastUpdatedTime() const -> int
 auto SubtitleRenderer::start(int time) const -> int
 {
     int ret = -1;
-    d->selection.forComponents([this, time, &ret] (const SubComp &comp) {
-        const auto it = comp.start(time - d->delay, d->fps());
+    const auto source = timing().unmap(time - d->delay);
+    d->selection.forComponents([this, source, &ret] (const SubComp &comp) {
+        const auto it = comp.start(source, d->fps());
         if (it != comp.end())
-            ret = qMax(ret, comp.isBasedOnFrame() ? comp.msec(it.key(), d->fps()) : it.key());
+            ret = qMax(ret, d->time(comp, it.key()));
     });
     return ret;
 }
@@ -469,22 +642,23 @@ auto SubtitleRenderer::start(int time) const -> int
 auto SubtitleRenderer::finish(int time) const -> int
 {
     int ret = -1;
-    d->selection.forComponents([this, time, &ret] (const SubComp &comp) {
-        const auto it = comp.finish(time - d->delay, d->fps());
+    const auto source = timing().unmap(time - d->delay);
+    d->selection.forComponents([this, source, &ret] (const SubComp &comp) {
+        const auto it = comp.finish(source, d->fps());
         if (it != comp.end()) {
-            const int t = comp.isBasedOnFrame() ? comp.msec(it.key(), d->fps()) : it.key();
+            const int t = d->time(comp, it.key());
             ret = ret == -1 ? t : qMin(ret, t);
         }
     });
     return ret;
 }
 
-static bool updateIfEarlier(SubComp::ConstIt it, int &time) {
+static bool updateIfEarlier(SubComp::ConstIt it, int key, int &time) {
     if (it->hasWords()) {
         if (time < 0)
-            time = it.key();
-        else if (it.key() > time)
-            time = it.key();
+            time = key;
+        else if (key > time)
+            time = key;
         return true;
     } else
         return false;
@@ -494,8 +668,10 @@ auto SubtitleRenderer::current() const -> int
 {
     int time = -1;
     d->selection.forImages([this, &time] (const SubCompImage &imageture) {
-        if (imageture.isValid())
-            updateIfEarlier(imageture.iterator(), time);
+        if (imageture.isValid()) {
+            const auto it = imageture.iterator();
+            updateIfEarlier(it, d->time(*imageture.component(), it.key()), time);
+        }
     });
     return time;
 }
@@ -506,8 +682,10 @@ auto SubtitleRenderer::previous() const -> int
     d->selection.forImages([this, &time] (const SubCompImage &imageture) {
         if (imageture.isValid()) {
             auto it = imageture.iterator();
-            while (it != imageture.component()->begin()) {
-                if (updateIfEarlier(--it, time))
+            const auto comp = imageture.component();
+            while (it != comp->begin()) {
+                --it;
+                if (updateIfEarlier(it, d->time(*comp, it.key()), time))
                     break;
             }
         }
@@ -521,8 +699,9 @@ auto SubtitleRenderer::next() const -> int
     d->selection.forImages([this, &time] (const SubCompImage &imageture) {
         if (imageture.isValid()) {
             auto it = imageture.iterator();
-            while (++it != imageture.component()->end()) {
-                if (updateIfEarlier(it, time))
+            const auto comp = imageture.component();
+            while (++it != comp->end()) {
+                if (updateIfEarlier(it, d->time(*comp, it.key()), time))
                     break;
             }
         }
@@ -1,15 +1,16 @@
 #ifndef SUBTITLERENDERERITEM_HPP
 #define SUBTITLERENDERERITEM_HPP
 
-#include "quick/simpletextureitem.hpp"
+#include "quick/opengldrawitem.hpp"
+#include "opengl/openglvertex.hpp"
 #include "player/streamtrack.hpp"
 
 class SubComp;                          class Subtitle;
-class RichTextDocument;
+class RichTextDocument;                 class SubTiming;
 struct OsdStyle;                        class SubtitleDrawer;
 enum class AutoselectMode;
 
-class SubtitleRenderer : public SimpleTextureItem  {
+class SubtitleRenderer : public ShaderRenderItem<OGL::TextureColorVertex> {
     Q_OBJECT
 public:
     SubtitleRenderer(QQuickItem *parent = nullptr);
@@ -32,6 +33,8 @@ public:
     auto setPos(double pos) -> void;
     auto isHidden() const -> bool;
     auto setDelay(int delay) -> void;
+    auto timing() const -> const SubTiming&;
+    auto setTiming(const SubTiming &timing) -> void;
 //    auto load(const Subtitle &subtitle, bool select) -> bool;
     auto unload() -> void;
     auto select(int id) -> void;
@@ -41,6 +44,8 @@ public:
     auto text() const -> const RichTextDocument&;
     auto draw(const QRectF &rect, QRectF *put = nullptr) const -> QImage;
     auto updateVertexOnGeometryChanged() const -> bool override { return true; }
+    auto drawingMode() const -> GLenum override { return GL_TRIANGLES; }
+    auto vertexCount() const -> int override;
     auto setHidden(bool hidden) -> void;
     auto render(int ms) -> void;
     auto setTopAligned(bool top) -> void;
@@ -61,7 +66,8 @@ private:
     auto createShader() const -> ShaderIface* override;
     auto createData() const -> ShaderData* override;
     auto type() const -> Type* override { static Type type; return &type; }
-    auto updateTexture(OpenGLTexture2D *texture) -> void override;
+    auto updateTexture() -> void;
+    auto updateGlyphs() -> bool;
     auto updateData(ShaderData *data) -> void override;
     auto updateVertex(Vertex *vertex) -> void override;
     struct Data; Data *d;
@@ -7,7 +7,7 @@ inline bool qMapLessThanKey(const SubCompItMapIt &lhs,
     return lhs.key() < rhs.key();
 }
 
-struct SubCompSelection::Thread::Data {
+struct SubCompSelection::Job::Data {
     Item *item = nullptr;
     int time = 0;
     const SubComp *comp = nullptr;
@@ -15,11 +15,9 @@ struct SubCompSelection::Thread::Data {
     SubCompItMapIt it = its.end();
     QMap<SubCompItMapIt, SubCompImage> pool;
     QObject *receiver = nullptr;
-    bool quit = false;
     double fps = 1.0, dpr = 1.0, mul = 1.0;
-    QMutex *mutex; QWaitCondition *wait;
     QRectF rect; SubtitleDrawer drawer;
-    SubCompSelection *selection = nullptr;
+    SubTiming timing;
 
     SubComp::ConstIt iterator(int time) const { return comp->start(time, fps); }
     auto newPicture(SubCompItMapIt it)
@@ -28,53 +26,63 @@ struct SubCompSelection::Thread::Data {
         drawer.draw(*pic, rect, dpr);
         return pic;
     }
-    auto update()
+    // returns false if dropped for new request such as seeking
+    auto update(const std::atomic<bool> &interrupted) -> bool
     {
-        if (quit)
-            return;
         auto post = [this] (const SubCompImage &pic)
             { _PostEvent(receiver, ImagePrepared, pic); };
         if (it != its.end()) {
             auto cache = pool.find(it);
-            if (cache == pool.end())
+            if (cache == pool.end() && !interrupted)
                 cache = newPicture(it);
+            if (interrupted) {
+                // nothing has been shown; next request draws again
+                it = its.end();
+                return false;
+            }
             post(*cache);
         } else
             post(comp);
+        return true;
     }
 
-    auto fillCache()
+    // returns false if interrupted by new request
+    auto fillCache(const std::atomic<bool> &interrupted) -> bool
     {
         if (it == its.end())
-            return;
+            return true;
         auto iit = pool.begin();
         while (iit != pool.end() && iit.key().key() < it.key())
             iit = pool.erase(iit);
-        Q_ASSERT(iit.key() == it);
+        if (iit == pool.end() || iit.key() != it)
+            return true;
         auto key = it;
         const int size = qMin(2, pool.size()+1);
         for (int i=0; i<size; ++i) {
             ++iit; ++key;
             if (key == its.end())
                 break;
+            if (interrupted)
+                return false;
             if (iit == pool.end())
                 iit = newPicture(key);
         }
+        return true;
     }
 
-    auto draw(bool force)
+    // returns true if next images can be prepared
+    auto draw(bool force, const std::atomic<bool> &interrupted) -> bool
     {
         auto iit = --its.upperBound(time);
         if (force || it != iit) {
             if (it == its.end() || ++it != iit) {
                 pool.clear();
                 it = iit;
-                update();
-            } else {
-                update();
-                fillCache();
-            }
+                update(interrupted);
+            } else
+                return update(interrupted);
         }
+        return false;
     }
 
     auto rebuild()
@@ -82,90 +90,182 @@ struct SubCompSelection::Thread::Data {
         pool.clear();
         its.clear();
         it = its.end();
+        // only index is rebuilt by retiming, captions are not copied
         for (auto iit = comp->begin(); iit != comp->end(); ++iit)
-            its.insert(comp->toTime(iit.key(), fps), iit);
+            its.insert(timing.map(comp->toTime(iit.key(), fps)), iit);
     }
 };
 
-SubCompSelection::Thread::Thread(QMutex *mutex, QWaitCondition *wait,
-                                 Item *item, SubCompSelection *selection,
-                                 QObject *renderer)
-    : QThread()
-    , d(new Data)
+SubCompSelection::Job::Job(Item *item, QObject *renderer)
+    : d(new Data)
 {
     d->item = item;
     d->comp = item->comp;
     d->receiver = renderer;
-    d->mutex = mutex;
-    d->wait = wait;
-    d->selection = selection;
 }
 
-SubCompSelection::Thread::~Thread()
+SubCompSelection::Job::~Job()
 {
-    finish();
     delete d;
 }
 
-auto SubCompSelection::Thread::setFPS(double fps) -> void
+auto SubCompSelection::Job::setFPS(double fps) -> void
 {
     this->fps = fps;
     flags |= Rebuild;
+    interrupted = true;
 }
 
-auto SubCompSelection::Thread::finish() -> void
+auto SubCompSelection::Job::setTiming(const SubTiming &timing) -> void
 {
-    d->quit = true;
-    d->wait->wakeAll();
-    if (!wait(5000))
-        terminate();
+    this->timing = timing;
+    flags |= Rebuild;
+    interrupted = true;
 }
 
-auto SubCompSelection::Thread::run() -> void
-{
+/******************************************************************************/
+
+// bounded set of workers shared by all components of all selections
+// requested drawing runs first in order of display time, then prefetching
+// of next captions; both are interrupted by seeking or new options
+// and image drawn for outdated request is dropped
+
+class SubCompSelection::Pool {
+    class Worker : public QThread {
+    public:
+        Worker(Pool *pool): m_pool(pool) { }
+    private:
+        auto run() -> void final { m_pool->work(); }
+        Pool *m_pool = nullptr;
+    };
+public:
+    Pool()
+    {
+        const int count = qBound(1, QThread::idealThreadCount() - 1, 2);
+        for (int i = 0; i < count; ++i) {
+            m_workers.push_back(new Worker(this));
+            m_workers.back()->start(QThread::LowPriority);
+        }
+    }
+    ~Pool()
+    {
+        m_mutex.lock();
+        m_quit = true;
+        m_mutex.unlock();
+        m_wake.wakeAll();
+        for (auto worker : m_workers) {
+            worker->wait();
+            delete worker;
+        }
+    }
+    static auto acquire() -> QSharedPointer<Pool>
+    {
+        static QWeakPointer<Pool> weak;
+        auto pool = weak.toStrongRef();
+        if (!pool) {
+            pool.reset(new Pool);
+            weak = pool;
+        }
+        return pool;
+    }
+    auto lock() -> void { m_mutex.lock(); }
+    auto unlock() -> void { m_mutex.unlock(); m_wake.wakeAll(); }
+    auto add(Job *job) -> void
+    {
+        QMutexLocker locker(&m_mutex);
+        m_jobs.push_back(job);
+    }
+    // blocks until job is not running
+    auto remove(Job *job) -> void
+    {
+        QMutexLocker locker(&m_mutex);
+        m_jobs.removeOne(job);
+        job->interrupted = true;
+        while (job->running)
+            m_done.wait(&m_mutex);
+    }
+private:
     static constexpr int NewOption = NewDrawer | NewArea;
     static constexpr int ForceUpdate = Rerender | Rebuild | NewOption;
-    int flags = 0;
-    while (!d->quit) {
-        QMutexLocker locker(d->mutex);
-        if (!(this->flags & ForceUpdate))
-            d->wait->wait(d->mutex);
-        if (d->quit)
-            break;
-        flags = this->flags;
-        this->flags = 0;
-        d->time = time;
-        d->fps = fps;
-        if (flags & NewOption) {
-            if (flags & NewDrawer)
-                d->drawer = drawer;
-            if (flags & NewArea) {
-                d->rect = rect;
-                d->dpr = dpr;
+    // mutex should be locked
+    auto next() const -> Job*
+    {
+        Job *job = nullptr;
+        for (auto j : m_jobs) {
+            if (j->running || !j->flags)
+                continue;
+            if (!job || j->time < job->time)
+                job = j;
+        }
+        if (job)
+            return job;
+        for (auto j : m_jobs) {
+            if (!j->running && j->prefetch)
+                return j;
+        }
+        return nullptr;
+    }
+    auto work() -> void
+    {
+        QMutexLocker locker(&m_mutex);
+        while (!m_quit) {
+            auto job = next();
+            if (!job) {
+                m_wake.wait(&m_mutex);
+                continue;
             }
+            job->running = true;
+            job->interrupted = false;
+            const int flags = job->flags;
+            job->flags = 0;
+            auto d = job->d;
+            if (flags) {
+                d->time = job->time;
+                d->fps = job->fps;
+                if (flags & Rebuild)
+                    d->timing = job->timing;
+                if (flags & NewDrawer)
+                    d->drawer = job->drawer;
+                if (flags & NewArea) {
+                    d->rect = job->rect;
+                    d->dpr = job->dpr;
+                }
+            }
+            locker.unlock();
+            bool prefetch = false;
+            if (flags) {
+                if (flags & Rebuild)
+                    d->rebuild();
+                if (flags & NewOption)
+                    d->pool.clear();
+                if (d->time > 0 && d->fps > 0.0 && !d->its.isEmpty())
+                    prefetch = d->draw(flags & ForceUpdate, job->interrupted);
+            } else
+                prefetch = !d->fillCache(job->interrupted);
+            locker.relock();
+            job->running = false;
+            // unchanged caption keeps pending prefetch of next ones
+            if (flags && !(flags & ForceUpdate))
+                prefetch = prefetch || job->prefetch;
+            job->prefetch = prefetch;
+            m_done.wakeAll();
         }
-        locker.unlock();
-        if (d->quit)
-            break;
-        if (flags & Rebuild)
-            d->rebuild();
-        if (flags & NewOption)
-            d->pool.clear();
-        if (d->quit)
-            break;
-        if (d->time > 0 && d->fps > 0.0 && !d->its.isEmpty())
-            d->draw(flags & ForceUpdate);
     }
-}
+    QMutex m_mutex;
+    QWaitCondition m_wake, m_done;
+    QList<Job*> m_jobs;
+    QVector<Worker*> m_workers;
+    bool m_quit = false;
+};
 
 /******************************************************************************/
 
 struct SubCompSelection::Data {
-    QMutex mutex;
-    QWaitCondition wait;
+    QSharedPointer<Pool> pool = Pool::acquire();
     QObject *renderer = nullptr;
     SubtitleDrawer drawer;
     QRectF rect;
+    SubTiming timing;
     double dpr = 1.0, fps = 30.0;
 };
 
@@ -177,13 +277,32 @@ SubCompSelection::SubCompSelection(QObject *renderer)
 
 SubCompSelection::~SubCompSelection()
 {
+    clear();
     delete d;
 }
 
+auto SubCompSelection::Item::release() -> void
+{
+    if (comp)
+        const_cast<SubComp*>(comp)->selection() = false;
+}
+
+auto SubCompSelection::lock() -> void
+{
+    d->pool->lock();
+}
+
+auto SubCompSelection::unlock() -> void
+{
+    d->pool->unlock();
+}
+
 auto SubCompSelection::remove(const SubComp *comp) -> void
 {
     auto it = find(comp);
     if (it != items.end()) {
+        d->pool->remove(it->job);
+        _Delete(it->job);
         it->release();
         items.erase(it);
     }
@@ -197,17 +316,18 @@ auto SubCompSelection::drawer() const -> const SubtitleDrawer&
 auto SubCompSelection::setDrawer(const SubtitleDrawer &drawer) -> void
 {
     d->drawer = drawer;
-    forThreads([this] (Thread *t) { t->setDrawer(d->drawer); });
+    forJobs([this] (Job *job) { job->setDrawer(d->drawer); });
 }
 
 auto SubCompSelection::clear() -> void
 {
     for (auto &item : items)
-        item.thread->finish();
-    wait.wakeAll();
+        d->pool->remove(item.job);
     qApp->removePostedEvents(d->renderer, ImagePrepared);
-    for (auto &item : items)
+    for (auto &item : items) {
+        _Delete(item.job);
         item.release();
+    }
     items.clear();
 }
 
@@ -216,7 +336,7 @@ auto SubCompSelection::setArea(const QRectF &rect, double dpr) -> void
     if (d->rect == rect && d->dpr == dpr)
         return;
     d->rect = rect; d->dpr = dpr;
-    forThreads([this] (Thread *thread) { thread->setArea(d->rect, d->dpr); });
+    forJobs([this] (Job *job) { job->setArea(d->rect, d->dpr); });
 }
 
 auto SubCompSelection::isEmpty() const -> bool
@@ -235,11 +355,12 @@ auto SubCompSelection::prepend(const SubComp *comp) -> bool
     items.push_front(Item());
     auto &item = items.front();
     item.comp = comp;
-    item.thread = new Thread(&mutex, &wait, &item, this, d->renderer);
-    item.thread->setFPS(d->fps);
-    item.thread->setDrawer(d->drawer);
-    item.thread->setArea(d->rect, d->dpr);
-    item.thread->start();
+    item.job = new Job(&item, d->renderer);
+    item.job->setFPS(d->fps);
+    item.job->setTiming(d->timing);
+    item.job->setDrawer(d->drawer);
+    item.job->setArea(d->rect, d->dpr);
+    d->pool->add(item.job);
     return true;
 }
 
@@ -251,7 +372,18 @@ auto SubCompSelection::fps() const -> double
 auto SubCompSelection::setFPS(double fps) -> void
 {
     if (_Change(d->fps, fps))
-        forThreads([this, fps] (Thread *t) { t->setFPS(fps); });
+        forJobs([fps] (Job *job) { job->setFPS(fps); });
+}
+
+auto SubCompSelection::timing() const -> const SubTiming&
+{
+    return d->timing;
+}
+
+auto SubCompSelection::setTiming(const SubTiming &timing) -> void
+{
+    if (_Change(d->timing, timing))
+        forJobs([&timing] (Job *job) { job->setTiming(timing); });
 }
 
 auto SubCompSelection::update(const SubCompImage &image) -> bool
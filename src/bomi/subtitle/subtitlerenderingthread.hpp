@@ -2,6 +2,8 @@
 #define SUBTITLERENDERINGTHREAD_HPP
 
 #include "subtitledrawer.hpp"
+#include "subtiming.hpp"
+#include <atomic>
 
 using SubCompItMap = QMap<int, SubComp::ConstIt>;
 using SubCompItMapIt = SubCompItMap::const_iterator;
@@ -14,27 +16,34 @@ public:
     };
 private:
     struct Item;
-    class Thread : public QThread {
+    class Pool;
+    // rendering state of a component which is run by shared pool
+    // setters should be called with pool mutex locked
+    class Job {
     public:
-        Thread(QMutex *mutex, QWaitCondition *wait, Item *item,
-               SubCompSelection *selection, QObject *renderer);
-        ~Thread();
+        Job(Item *item, QObject *renderer);
+        ~Job();
         auto setFPS(double fps) -> void;
+        auto setTiming(const SubTiming &timing) -> void;
         auto render(int time, int flags) -> void;
         auto setArea(const QRectF &rect, double dpr) -> void;
         auto setDrawer(const SubtitleDrawer &drawer) -> void;
-        auto finish() -> void;
-        auto run() -> void;
     private:
+        friend class Pool;
+        static constexpr int SeekJump = 1000;
         QRectF rect;
         double dpr = 1.0, fps = 1.0;
         SubtitleDrawer drawer;
+        SubTiming timing;
         int time = 0, flags = 0;
+        // pool state
+        bool running = false, prefetch = false;
+        std::atomic<bool> interrupted{false};
         struct Data; Data *d;
     };
     struct Item {
         auto release() -> void;
-        Thread *thread  = nullptr;
+        Job *job = nullptr;
         const SubComp *comp = nullptr;
         SubCompImage image{nullptr};
     };
@@ -60,6 +69,8 @@ public:
     auto update(const SubCompImage &pic) -> bool;
     auto fps() const -> double;
     auto setFPS(double fps) -> void;
+    auto timing() const -> const SubTiming&;
+    auto setTiming(const SubTiming &timing) -> void;
     auto setMargin(double top, double bottom,
                    double right, double left) -> void;
 private:
@@ -67,23 +78,30 @@ private:
     auto find(const SubComp *comp) -> List::iterator;
     auto find(const SubComp *comp) const -> List::const_iterator;
     template<class Func>
-    auto forThreads(Func func) -> void;
-    List items; mutable QMutex mutex;
-    mutable QWaitCondition wait;
+    auto forJobs(Func func) -> void;
+    auto lock() -> void;
+    auto unlock() -> void;
+    List items;
     struct Data;
     Data *d;
     QVector<SubCompImage> m_images;
 };
 
-inline auto SubCompSelection::Thread::render(int time, int flags) -> void
-{ this->time = time; this->flags |= flags; }
+inline auto SubCompSelection::Job::render(int time, int flags) -> void
+{
+    // plain tick keeps prefetching unless time jumps by seeking
+    if (flags != Tick || time < this->time || time - this->time > SeekJump)
+        interrupted = true;
+    this->time = time;
+    this->flags |= flags;
+}
 
-inline auto SubCompSelection::Thread::setArea(const QRectF &rect,
-                                              double dpr) -> void
-{ this->rect = rect; this->dpr = dpr; flags |= NewArea; }
+inline auto SubCompSelection::Job::setArea(const QRectF &rect,
+                                           double dpr) -> void
+{ this->rect = rect; this->dpr = dpr; flags |= NewArea; interrupted = true; }
 
-inline auto SubCompSelection::Thread::setDrawer(const SubtitleDrawer &d) -> void
-{ this->drawer = d; flags |= NewDrawer; }
+inline auto SubCompSelection::Job::setDrawer(const SubtitleDrawer &d) -> void
+{ this->drawer = d; flags |= NewDrawer; interrupted = true; }
 
 template<class LessThan>
 inline auto SubCompSelection::sort(LessThan lt) -> void
@@ -102,14 +120,7 @@ inline auto SubCompSelection::forImages(F f) const -> void
 { for (const auto &item : items) f(item.image); }
 
 inline auto SubCompSelection::render(int ms, int flags) -> void
-{ forThreads([this, ms, flags] (Thread *t) { t->render(ms, flags); }); }
-
-inline auto SubCompSelection::Item::release() -> void
-{
-    _Delete(thread);
-    if (comp)
-        const_cast<SubComp*>(comp)->selection() = false;
-}
+{ forJobs([ms, flags] (Job *job) { job->render(ms, flags); }); }
 
 inline auto SubCompSelection::contains(const SubComp *comp) const -> bool
 { return find(comp) != items.end(); }
@@ -134,12 +145,11 @@ inline auto SubCompSelection::find(const SubComp *comp) const
 }
 
 template<class Func>
-inline auto SubCompSelection::forThreads(Func func) -> void {
-    mutex.lock();
+inline auto SubCompSelection::forJobs(Func func) -> void {
+    lock();
     for (const auto &item : items)
-        func(item.thread);
-    mutex.unlock();
-    wait.wakeAll();
+        func(item.job);
+    unlock();
 }
 
 #endif // SUBTITLERENDERINGTHREAD_HPP
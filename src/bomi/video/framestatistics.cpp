@@ -0,0 +1,199 @@
+#include "framestatistics.hpp"
+#include "mpimage.hpp"
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// ~540 rows are enough to estimate average luma of any frame
+static constexpr int AutoRows = 540;
+
+auto FrameStatistics::autoStep(int height) -> int
+{
+    return qMax(1, height / AutoRows);
+}
+
+auto FrameStatistics::difference(const FrameStatistics &other) const -> double
+{
+    if (!binned || !other.binned)
+        return 1.0;
+    double diff = 0;
+    for (int i = 0; i < Bins; ++i)
+        diff += qAbs(histogram[i]/(double)binned
+                     - other.histogram[i]/(double)other.binned);
+    return diff * 0.5;
+}
+
+auto FrameStatistics::ratioBelow(double luma) const -> double
+{
+    if (!binned)
+        return 0.0;
+    if (limited)
+        luma = (16.0 + luma * (235.0 - 16.0))/255.0;
+    const int bins = qBound(0, qRound(luma * Bins), Bins);
+    int count = 0;
+    for (int i = 0; i < bins; ++i)
+        count += histogram[i];
+    return count/(double)binned;
+}
+
+/******************************************************************************/
+
+// sum of n samples; packed YUYV/UYVY rows are passed with pitch 2 and offset
+
+#ifdef __SSE2__
+SIA sad(__m128i acc) -> quint64
+{
+    alignas(16) quint64 lanes[2];
+    _mm_store_si128((__m128i*)lanes, acc);
+    return lanes[0] + lanes[1];
+}
+#endif
+
+static auto sumRow8(const quint8 *p, int n) -> quint64
+{
+    quint64 sum = 0;
+    int i = 0;
+#ifdef __SSE2__
+    const auto zero = _mm_setzero_si128();
+    auto acc = _mm_setzero_si128();
+    for (; i + 16 <= n; i += 16) {
+        const auto v = _mm_loadu_si128((const __m128i*)(p + i));
+        acc = _mm_add_epi64(acc, _mm_sad_epu8(v, zero));
+    }
+    sum = sad(acc);
+#endif
+    for (; i < n; ++i)
+        sum += p[i];
+    return sum;
+}
+
+static auto sumRow16(const quint16 *p, int n) -> quint64
+{
+    quint64 sum = 0;
+    int i = 0;
+#ifdef __SSE2__
+    // 32-bit lanes cannot overflow within a row of less than 2^18 pixels
+    const auto zero = _mm_setzero_si128();
+    auto acc = _mm_setzero_si128();
+    for (; i + 8 <= n; i += 8) {
+        const auto v = _mm_loadu_si128((const __m128i*)(p + i));
+        acc = _mm_add_epi32(acc, _mm_unpacklo_epi16(v, zero));
+        acc = _mm_add_epi32(acc, _mm_unpackhi_epi16(v, zero));
+    }
+    alignas(16) quint32 lanes[4];
+    _mm_store_si128((__m128i*)lanes, acc);
+    sum = (quint64)lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#endif
+    for (; i < n; ++i)
+        sum += p[i];
+    return sum;
+}
+
+static auto sumRowPacked(const quint8 *p, int offset, int n) -> quint64
+{
+    quint64 sum = 0;
+    int i = 0;
+#ifdef __SSE2__
+    const auto zero = _mm_setzero_si128();
+    const auto mask = _mm_set1_epi16(0x00ff);
+    auto acc = _mm_setzero_si128();
+    for (; i + 8 <= n; i += 8) {
+        auto v = _mm_loadu_si128((const __m128i*)(p + i*2));
+        v = offset ? _mm_srli_epi16(v, 8) : _mm_and_si128(v, mask);
+        acc = _mm_add_epi64(acc, _mm_sad_epu8(v, zero));
+    }
+    sum = sad(acc);
+#endif
+    for (; i < n; ++i)
+        sum += p[i*2 + offset];
+    return sum;
+}
+
+template<class T>
+static auto binRow(const T *p, int n, int pitch, int step, int shift,
+                   FrameStatistics &s) -> void
+{
+    const auto end = p + n * pitch;
+    const int inc = pitch * step;
+    for (; p < end; p += inc, ++s.binned)
+        ++s.histogram[qMin<int>(*p >> shift, FrameStatistics::Bins - 1)];
+}
+
+template<class T, class Sum>
+static auto accumulate(const mp_image *mpi, int bits, int pitch, int offset, int step,
+                       bool histogram, FrameStatistics &s, Sum sumRow) -> quint64
+{
+    const int shift = qMax(0, bits - FrameStatistics::BinBits);
+    quint64 sum = 0;
+    for (int y = 0; y < mpi->h; y += step) {
+        auto p = (const T*)(mpi->planes[0] + y * mpi->stride[0]);
+        sum += sumRow(p);
+        s.samples += mpi->w;
+        if (histogram)
+            binRow(p + offset, mpi->w, pitch, step, shift, s);
+    }
+    return sum;
+}
+
+auto FrameStatistics::compute(const mp_image *mpi, int step, bool histogram) -> FrameStatistics
+{
+    FrameStatistics s;
+    step = step <= AutoStep ? autoStep(mpi->h) : step;
+    const int w = mpi->w;
+    int bits = mpi->fmt.plane_bits;
+    quint64 sum = 0;
+    switch (mpi->imgfmt) {
+    case IMGFMT_420P:   case IMGFMT_NV12:   case IMGFMT_NV21:
+    case IMGFMT_444P:   case IMGFMT_422P:   case IMGFMT_440P:
+    case IMGFMT_411P:   case IMGFMT_410P:   case IMGFMT_Y8:
+    case IMGFMT_444AP:  case IMGFMT_422AP:  case IMGFMT_420AP:
+        sum = accumulate<quint8>(mpi, bits, 1, 0, step, histogram, s,
+                                 [w] (const quint8 *p) { return sumRow8(p, w); });
+        break;
+    case IMGFMT_444P16: case IMGFMT_444P14: case IMGFMT_444P12:
+    case IMGFMT_444P10: case IMGFMT_444P9:  case IMGFMT_422P16:
+    case IMGFMT_422P14: case IMGFMT_422P12: case IMGFMT_422P10:
+    case IMGFMT_422P9:  case IMGFMT_420P16: case IMGFMT_420P14:
+    case IMGFMT_420P12: case IMGFMT_420P10: case IMGFMT_420P9:
+    case IMGFMT_Y16:
+        sum = accumulate<quint16>(mpi, bits, 1, 0, step, histogram, s,
+                                  [w] (const quint16 *p) { return sumRow16(p, w); });
+        break;
+    case IMGFMT_YUYV:   case IMGFMT_UYVY: {
+        // plane_bits counts all components of packed pixel
+        const int offset = mpi->imgfmt == IMGFMT_UYVY;
+        bits = 8;
+        sum = accumulate<quint8>(mpi, bits, 2, offset, step, histogram, s,
+                                 [w, offset] (const quint8 *p)
+                                     { return sumRowPacked(p, offset, w); });
+        break;
+    } default:
+        return s;
+    }
+    if (!s.samples)
+        return FrameStatistics();
+    const double max = (1 << bits) - 1;
+    s.luma = sum / (double)s.samples / max;
+    if (step > 1) {
+        // variance from histogram if any, otherwise Bhatia-Davis bound;
+        // samples in a row are correlated, so only rows count as samples
+        double var = s.luma * (1.0 - s.luma);
+        if (s.binned) {
+            double m1 = 0, m2 = 0;
+            for (int i = 0; i < Bins; ++i) {
+                const double x = (i + 0.5)/Bins;
+                m1 += x * s.histogram[i];
+                m2 += x * x * s.histogram[i];
+            }
+            m1 /= s.binned; m2 /= s.binned;
+            var = qMax(0.0, m2 - m1 * m1) + 1.0/(12.0 * Bins * Bins);
+        }
+        s.error = 3.0 * std::sqrt(var / (s.samples / w));
+    }
+    s.limited = mpi->params.colorlevels == MP_CSP_LEVELS_TV;
+    if (s.limited) {
+        s.luma = (s.luma - 16.0/255)*255.0/(235.0 - 16.0);
+        s.error *= 255.0/(235.0 - 16.0);
+    }
+    return s;
+}
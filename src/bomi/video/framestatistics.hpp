@@ -0,0 +1,28 @@
+#ifndef FRAMESTATISTICS_HPP
+#define FRAMESTATISTICS_HPP
+
+struct mp_image;
+
+struct FrameStatistics {
+    static constexpr int BinBits = 5;
+    static constexpr int Bins = 1 << BinBits;
+    // pick step from frame height
+    static constexpr int AutoStep = 0;
+    static auto autoStep(int height) -> int;
+    auto isValid() const -> bool { return luma >= 0; }
+    // half of L1 distance between normalized histograms in [0, 1]
+    auto difference(const FrameStatistics &other) const -> double;
+    // ratio of samples darker than normalized luma
+    auto ratioBelow(double luma) const -> double;
+    // step > 1 sums every step-th row and bins every step-th column of them
+    static auto compute(const mp_image *mpi, int step = 1,
+                        bool histogram = true) -> FrameStatistics;
+    double luma = -1.0; // normalized average in [0, 1]
+    // bound of |luma - exact average| at 99.7% confidence, 0 if not subsampled
+    double error = 0.0;
+    int samples = 0, binned = 0;
+    bool limited = false;
+    std::array<int, Bins> histogram = {{}};
+};
+
+#endif // FRAMESTATISTICS_HPP
@@ -0,0 +1,91 @@
+#include "frametimings.hpp"
+
+// intervals longer than this are pauses, not stutters
+static constexpr quint32 MaxVsyncUs = 1000000;
+
+FrameTimings::FrameTimings()
+{
+    for (auto &ring : m_rings) {
+        for (auto &us : ring.us)
+            us.store(0, std::memory_order_relaxed);
+    }
+}
+
+auto FrameTimings::name(Stage stage) -> const char*
+{
+    switch (stage) {
+    case FilterIn:      return "filterIn";
+    case FilterOut:     return "filterOut";
+    case Deinterlacer:  return "deinterlacer";
+    case Interpolator:  return "interpolator";
+    case Render:        return "render";
+    case Vsync:         return "vsync";
+    default:            return "";
+    }
+}
+
+auto FrameTimings::record(Stage stage, qint64 nsecs) -> void
+{
+    auto &ring = m_rings[stage];
+    const auto idx = ring.count.fetch_add(1, std::memory_order_relaxed);
+    const auto us = qBound<qint64>(0, (nsecs + 500)/1000, UINT_MAX);
+    ring.us[idx % Capacity].store(us, std::memory_order_relaxed);
+}
+
+auto FrameTimings::swapped() -> void
+{
+    if (!m_rendered)
+        return;
+    m_rendered = false;
+    if (m_swap.isValid()) {
+        const auto ns = m_swap.nsecsElapsed();
+        if (ns < MaxVsyncUs * 1000ll)
+            record(Vsync, ns);
+    }
+    m_swap.start();
+}
+
+auto FrameTimings::clear() -> void
+{
+    for (auto &ring : m_rings)
+        ring.count.store(0, std::memory_order_relaxed);
+}
+
+auto FrameTimings::samples(Stage stage) const -> QVector<quint32>
+{
+    auto &ring = m_rings[stage];
+    const int count = qMin<quint32>(ring.count.load(std::memory_order_relaxed), Capacity);
+    QVector<quint32> samples(count);
+    for (int i = 0; i < count; ++i)
+        samples[i] = ring.us[i].load(std::memory_order_relaxed);
+    std::sort(samples.begin(), samples.end());
+    return samples;
+}
+
+auto FrameTimings::summary(Stage stage) const -> Summary
+{
+    Summary s;
+    s.count = m_rings[stage].count.load(std::memory_order_relaxed);
+    const auto sorted = samples(stage);
+    if (sorted.isEmpty())
+        return s;
+    auto at = [&] (double p)
+        { return sorted[qMin<int>(sorted.size() * p, sorted.size() - 1)] * 1e-3; };
+    s.p50 = at(0.5);
+    s.p90 = at(0.9);
+    s.p99 = at(0.99);
+    s.max = sorted.back() * 1e-3;
+    return s;
+}
+
+auto FrameTimings::lateHistogram() const -> std::array<int, LateBins>
+{
+    std::array<int, LateBins> bins = {{}};
+    const auto sorted = samples(Vsync);
+    if (sorted.isEmpty())
+        return bins;
+    const double median = qMax<quint32>(1, sorted[sorted.size()/2]);
+    for (auto us : sorted)
+        ++bins[qBound(0, qRound(us/median) - 1, LateBins - 1)];
+    return bins;
+}
@@ -0,0 +1,53 @@
+#ifndef FRAMETIMINGS_HPP
+#define FRAMETIMINGS_HPP
+
+#include <QElapsedTimer>
+#include <atomic>
+
+// lock-free recorder for per-frame costs
+// each stage keeps last Capacity samples in a ring which any thread can write
+
+class FrameTimings {
+public:
+    enum Stage {
+        FilterIn, FilterOut, Deinterlacer, Interpolator, Render, Vsync, StageCount
+    };
+    static constexpr int Capacity = 512;
+    // vsync intervals are bucketed by multiples of median interval: 1, 2, 3, 4+
+    static constexpr int LateBins = 4;
+    struct Summary {
+        int count = 0; // total recorded including overwritten ones
+        double p50 = 0, p90 = 0, p99 = 0, max = 0; // in ms
+    };
+    class Scope {
+    public:
+        Scope(FrameTimings *timings, Stage stage)
+            : m_timings(timings), m_stage(stage) { if (m_timings) m_timer.start(); }
+        ~Scope() { if (m_timings) m_timings->record(m_stage, m_timer.nsecsElapsed()); }
+    private:
+        FrameTimings *m_timings = nullptr;
+        Stage m_stage;
+        QElapsedTimer m_timer;
+    };
+    FrameTimings();
+    auto record(Stage stage, qint64 nsecs) -> void;
+    // call in render thread
+    auto rendered() -> void { m_rendered = true; }
+    auto swapped() -> void;
+    auto clear() -> void;
+    auto summary(Stage stage) const -> Summary;
+    auto lateHistogram() const -> std::array<int, LateBins>;
+    static auto name(Stage stage) -> const char*;
+private:
+    auto samples(Stage stage) const -> QVector<quint32>;
+    struct Ring {
+        std::atomic<quint32> count{0};
+        std::array<std::atomic<quint32>, Capacity> us;
+    };
+    std::array<Ring, StageCount> m_rings;
+    // render thread only
+    QElapsedTimer m_swap;
+    bool m_rendered = false;
+};
+
+#endif // FRAMETIMINGS_HPP
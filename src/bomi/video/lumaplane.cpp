@@ -0,0 +1,82 @@
+#include "lumaplane.hpp"
+#include "mpimage.hpp"
+
+template<class T>
+static auto decimateRows(const mp_image *src, int offset, int pitch, int step,
+                         mp_image *dst) -> void
+{
+    const int inc = pitch * step;
+    for (int y = 0; y < dst->h; ++y) {
+        auto s = (const T*)(src->planes[0] + y * step * src->stride[0]) + offset;
+        auto d = (T*)(dst->planes[0] + y * dst->stride[0]);
+        for (int x = 0; x < dst->w; ++x, s += inc)
+            *d++ = *s;
+    }
+}
+
+LumaPlane::~LumaPlane()
+{
+    clear();
+}
+
+auto LumaPlane::clear() -> void
+{
+    talloc_free(m_image);
+    talloc_free(m_scratch);
+    m_image = m_scratch = nullptr;
+}
+
+auto LumaPlane::reuse(mp_image *&mpi, int imgfmt, int w, int h) -> mp_image*
+{
+    if (!mpi || mpi->imgfmt != imgfmt || mpi->w != w || mpi->h != h) {
+        talloc_free(mpi);
+        mpi = mp_image_alloc(imgfmt, w, h);
+    }
+    return mpi;
+}
+
+auto LumaPlane::scratch(int imgfmt, int w, int h) -> mp_image*
+{
+    return reuse(m_scratch, imgfmt, w, h);
+}
+
+auto LumaPlane::decimate(const mp_image *src, int step) -> bool
+{
+    step = qMax(1, step);
+    int offset = 0, pitch = 1, imgfmt = IMGFMT_Y8;
+    switch (src->imgfmt) {
+    case IMGFMT_420P:   case IMGFMT_NV12:   case IMGFMT_NV21:
+    case IMGFMT_444P:   case IMGFMT_422P:   case IMGFMT_440P:
+    case IMGFMT_411P:   case IMGFMT_410P:   case IMGFMT_Y8:
+    case IMGFMT_444AP:  case IMGFMT_422AP:  case IMGFMT_420AP:
+        break;
+    case IMGFMT_444P16: case IMGFMT_444P14: case IMGFMT_444P12:
+    case IMGFMT_444P10: case IMGFMT_444P9:  case IMGFMT_422P16:
+    case IMGFMT_422P14: case IMGFMT_422P12: case IMGFMT_422P10:
+    case IMGFMT_422P9:  case IMGFMT_420P16: case IMGFMT_420P14:
+    case IMGFMT_420P12: case IMGFMT_420P10: case IMGFMT_420P9:
+    case IMGFMT_Y16:
+        imgfmt = IMGFMT_Y16;
+        break;
+    case IMGFMT_YUYV:   case IMGFMT_UYVY:
+        offset = src->imgfmt == IMGFMT_UYVY;
+        pitch = 2;
+        break;
+    default:
+        return false;
+    }
+    const int w = (src->w + step - 1)/step, h = (src->h + step - 1)/step;
+    auto dst = reuse(m_image, imgfmt, w, h);
+    if (!dst)
+        return false;
+    if (imgfmt == IMGFMT_Y16)
+        decimateRows<quint16>(src, offset, pitch, step, dst);
+    else
+        decimateRows<quint8>(src, offset, pitch, step, dst);
+    // keep significant bits of source, e.g., 10 bits in 16-bit container
+    if (imgfmt == IMGFMT_Y16)
+        dst->fmt.plane_bits = src->fmt.plane_bits;
+    dst->pts = src->pts;
+    dst->params.colorlevels = src->params.colorlevels;
+    return true;
+}
@@ -0,0 +1,27 @@
+#ifndef LUMAPLANE_HPP
+#define LUMAPLANE_HPP
+
+struct mp_image;
+
+// reusable buffer for decimated luma of a frame which is cheap to analyze
+// buffers are reallocated only when format or size changes
+
+class LumaPlane {
+public:
+    LumaPlane() = default;
+    LumaPlane(const LumaPlane &) = delete;
+    LumaPlane &operator = (const LumaPlane &) = delete;
+    ~LumaPlane();
+    // copy every step-th sample of every step-th row of luma from src
+    auto decimate(const mp_image *src, int step) -> bool;
+    // Y8 or Y16 image filled by last successful decimate()
+    auto image() const -> const mp_image* { return m_image; }
+    // full size buffer for backends which cannot read a part of surface
+    auto scratch(int imgfmt, int w, int h) -> mp_image*;
+    auto clear() -> void;
+private:
+    static auto reuse(mp_image *&mpi, int imgfmt, int w, int h) -> mp_image*;
+    mp_image *m_image = nullptr, *m_scratch = nullptr;
+};
+
+#endif // LUMAPLANE_HPP
@@ -0,0 +1,243 @@
+#include "videoanalyzer.hpp"
+#include "videoprocessor.hpp"
+#include "framestatistics.hpp"
+#include "mpimage.hpp"
+#include "player/mpv.hpp"
+#include "player/mpv_helper.hpp"
+#include "misc/log.hpp"
+
+DECLARE_LOG_CONTEXT(Video)
+
+enum EventType { Finished = QEvent::User + 1 };
+
+static constexpr int Version = 1;
+// sum every 4th row and bin every 4th column of them
+static constexpr int Step = 4;
+static constexpr double BlackLuma = 0.005, BlackPixel = 0.05, BlackRatio = 0.98;
+static constexpr double CutThreshold = 0.45;
+static constexpr int MinCutInterval = 1000;
+
+auto VideoAnalysis::nextBlackFrame(int time, int limit) const -> int
+{
+    for (auto &range : blacks) {
+        if (range.start > time)
+            return range.start - time <= limit ? range.start : -1;
+    }
+    return -1;
+}
+
+auto VideoAnalysis::sceneCut(int time, int direction) const -> int
+{
+    if (direction > 0) {
+        auto it = std::upper_bound(cuts.begin(), cuts.end(), time);
+        return it == cuts.end() ? -1 : *it;
+    }
+    // allow to skip the cut just passed
+    auto it = std::lower_bound(cuts.begin(), cuts.end(), time - 500);
+    return it == cuts.begin() ? -1 : *(--it);
+}
+
+auto VideoAnalysis::toByteArray() const -> QByteArray
+{
+    QByteArray data;
+    QDataStream out(&data, QIODevice::WriteOnly);
+    out << Version << duration << blacks.size();
+    for (auto &range : blacks)
+        out << range.start << range.end;
+    out << cuts;
+    return data;
+}
+
+auto VideoAnalysis::fromByteArray(const QByteArray &data) -> VideoAnalysis
+{
+    VideoAnalysis analysis;
+    if (data.isEmpty())
+        return analysis;
+    QDataStream in(data);
+    int version = 0, size = 0;
+    in >> version;
+    if (version != Version)
+        return analysis;
+    in >> analysis.duration >> size;
+    analysis.blacks.resize(size);
+    for (auto &range : analysis.blacks)
+        in >> range.start >> range.end;
+    in >> analysis.cuts;
+    if (in.status() != QDataStream::Ok)
+        return VideoAnalysis();
+    return analysis;
+}
+
+// mpv creates its core thread in mpv_initialize() and the core creates
+// demuxing and decoding threads, all of which inherit scheduling of the
+// creator on Linux; initializing in idle thread lowers all of them
+class IdleInitializer : public QThread {
+public:
+    IdleInitializer(std::function<void(void)> &&init): m_init(std::move(init)) { }
+private:
+    auto run() -> void final { m_init(); }
+    std::function<void(void)> m_init;
+};
+
+struct VideoAnalyzer::Data {
+    VideoAnalyzer *p = nullptr;
+    Mpv mpv;
+    VideoProcessor vp;
+    QList<Mrl> queue;
+    Mrl mrl;
+    bool quit = false;
+
+    QMutex mutex;
+    VideoAnalysis result;
+    FrameStatistics prev;
+    int blackStart = -1, last = -1, lastCut = -1;
+
+    auto reset() -> void
+    {
+        QMutexLocker locker(&mutex);
+        result = VideoAnalysis();
+        prev = FrameStatistics();
+        blackStart = last = lastCut = -1;
+    }
+    // called in filter thread
+    auto detect(const mp_image *mpi) -> void
+    {
+        if (mpi->pts == MP_NOPTS_VALUE)
+            return;
+        const auto s = FrameStatistics::compute(mpi, Step);
+        if (!s.isValid())
+            return;
+        const int time = s2ms(mpi->pts);
+        const bool black = s.luma < BlackLuma || s.ratioBelow(BlackPixel) > BlackRatio;
+        QMutexLocker locker(&mutex);
+        if (time <= last) // seek or broken timestamp
+            return;
+        if (black) {
+            if (blackStart < 0)
+                blackStart = time;
+        } else {
+            if (blackStart >= 0) {
+                result.blacks.push_back({blackStart, last});
+                blackStart = -1;
+            }
+            if (prev.isValid() && s.difference(prev) > CutThreshold
+                    && (lastCut < 0 || time - lastCut > MinCutInterval)) {
+                result.cuts.push_back(time);
+                lastCut = time;
+            }
+        }
+        prev = s;
+        last = time;
+    }
+    auto finish() -> VideoAnalysis
+    {
+        QMutexLocker locker(&mutex);
+        if (blackStart >= 0)
+            result.blacks.push_back({blackStart, last});
+        result.duration = qMax(last, 1);
+        return std::move(result);
+    }
+    auto next() -> void
+    {
+        if (quit || queue.isEmpty()) {
+            mrl = Mrl();
+            return;
+        }
+        mrl = queue.takeFirst();
+        reset();
+        _Debug("Start to analyze %%", mrl.toString());
+        mpv.tellAsync("loadfile", mrl.toLocalFile().toUtf8());
+    }
+};
+
+VideoAnalyzer::VideoAnalyzer(QObject *parent)
+    : QObject(parent), d(new Data)
+{
+    d->p = this;
+    d->mpv.setLogContext("mpv/analyzer"_b);
+    d->mpv.create();
+    d->mpv.setObserver(this);
+    d->mpv.request(MPV_EVENT_END_FILE, [=] (mpv_event *event) {
+        const auto reason = static_cast<mpv_event_end_file*>(event->data)->reason;
+        _PostEvent(this, Finished, reason);
+    });
+    d->vp.setFrameAnalyzer([=] (const mp_image *mpi) { d->detect(mpi); });
+    d->mpv.setOption("vo", "null");
+    d->mpv.setOption("ao", "null");
+    d->mpv.setOption("untimed", "yes");
+    d->mpv.setOption("hwdec", "no");
+    d->mpv.setOption("aid", "no");
+    d->mpv.setOption("sid", "no");
+    d->mpv.setOption("audio-file-auto", "no");
+    d->mpv.setOption("sub-auto", "no");
+    d->mpv.setOption("osd-level", "0");
+    d->mpv.setOption("resume-playback", "no");
+    // keep it cheap: one decoding thread with cheap decoding tricks
+    d->mpv.setOption("vd-lavc-threads", "1");
+    d->mpv.setOption("vd-lavc-fast", "yes");
+    d->mpv.setOption("vd-lavc-skiploopfilter", "all");
+    const auto vf = "noformat:address="_b + address_cast<QByteArray>(&d->vp);
+    d->mpv.setOption("vf", vf.constData());
+    IdleInitializer init([=] () { d->mpv.initialize(Log::Error, false); });
+    init.start(QThread::IdlePriority);
+    init.wait();
+    d->mpv.start(QThread::LowestPriority);
+}
+
+VideoAnalyzer::~VideoAnalyzer()
+{
+    shutdown();
+    if (d->mpv.isRunning())
+        d->mpv.wait();
+    d->mpv.destroy();
+    delete d;
+}
+
+auto VideoAnalyzer::analyze(const Mrl &mrl) -> void
+{
+    if (d->quit || !mrl.isLocalFile() || isQueued(mrl))
+        return;
+    d->queue.push_back(mrl);
+    if (d->mrl.isEmpty())
+        d->next();
+}
+
+auto VideoAnalyzer::isQueued(const Mrl &mrl) const -> bool
+{
+    return d->mrl == mrl || d->queue.contains(mrl);
+}
+
+auto VideoAnalyzer::cancel() -> void
+{
+    d->queue.clear();
+    if (!d->mrl.isEmpty())
+        d->mpv.tellAsync("stop");
+}
+
+auto VideoAnalyzer::shutdown() -> void
+{
+    if (_Change(d->quit, true)) {
+        d->queue.clear();
+        d->mpv.tellAsync("quit");
+    }
+}
+
+auto VideoAnalyzer::customEvent(QEvent *event) -> void
+{
+    switch ((int)event->type()) {
+    case Finished: {
+        const auto reason = _GetData<int>(event);
+        const auto mrl = d->mrl;
+        auto result = d->finish();
+        if (reason == MPV_END_FILE_REASON_EOF && !mrl.isEmpty()) {
+            _Debug("%% black ranges and %% scene cuts found in %%",
+                   result.blacks.size(), result.cuts.size(), mrl.toString());
+            emit analyzed(mrl, result);
+        }
+        d->next();
+        break;
+    } default:
+        d->mpv.process(event);
+        break;
+    }
+}
@@ -0,0 +1,42 @@
+#ifndef VIDEOANALYZER_HPP
+#define VIDEOANALYZER_HPP
+
+#include "player/mrl.hpp"
+
+struct VideoAnalysis {
+    struct Range {
+        DECL_EQ(Range, &T::start, &T::end)
+        int start = 0, end = 0;
+    };
+    auto isEmpty() const -> bool { return duration <= 0; }
+    // start of the first black range after time within limit, -1 if none
+    auto nextBlackFrame(int time, int limit) const -> int;
+    // nearest scene cut in given direction, -1 if none
+    auto sceneCut(int time, int direction) const -> int;
+    auto toByteArray() const -> QByteArray;
+    static auto fromByteArray(const QByteArray &data) -> VideoAnalysis;
+    int duration = 0;
+    QVector<Range> blacks;
+    QVector<int> cuts;
+};
+
+Q_DECLARE_METATYPE(VideoAnalysis)
+
+class VideoAnalyzer : public QObject {
+    Q_OBJECT
+public:
+    VideoAnalyzer(QObject *parent = nullptr);
+    ~VideoAnalyzer();
+    auto analyze(const Mrl &mrl) -> void;
+    auto isQueued(const Mrl &mrl) const -> bool;
+    auto cancel() -> void;
+    auto shutdown() -> void;
+signals:
+    void analyzed(const Mrl &mrl, const VideoAnalysis &analysis);
+private:
+    auto customEvent(QEvent *event) -> void final;
+    struct Data;
+    Data *d;
+};
+
+#endif // VIDEOANALYZER_HPP
@@ -1,6 +1,9 @@
 #include "videoprocessor.hpp"
 #include "videofilter.hpp"
 #include "mpimage.hpp"
+#include "framestatistics.hpp"
+#include "lumaplane.hpp"
+#include "frametimings.hpp"
 #include "softwaredeinterlacer.hpp"
 #include "motioninterpolator.hpp"
 #include "motionintrploption.hpp"
@@ -64,9 +67,33 @@ public:
         auto img = OS::hwAcc()->download(m_ctx, src.data(), m_pool);
         return img ? MpImage::wrap(img) : MpImage();
     }
+    // decimated luma in reusable buffer which is valid until next call
+    virtual auto downloadLuma(const MpImage &src, int step) -> const mp_image*
+    {
+        if (OS::hwAcc()->downloadLuma(m_ctx, src.data(), step, &m_luma))
+            return m_luma.image();
+        const auto img = download(src);
+        if (img.isNull() || !m_luma.decimate(img.data(), step))
+            return nullptr;
+        return m_luma.image();
+    }
 protected:
     mp_hwdec_ctx *m_ctx = nullptr;
     mp_image_pool *m_pool = nullptr;
+    LumaPlane m_luma;
+};
+
+// emulates hwdec interface on software-decoded frames for testing
+// enabled by BOMI_EMULATE_HWDEC=1, which should be used with hwdec disabled
+
+class SoftwareHwDecTool : public HwDecTool {
+public:
+    SoftwareHwDecTool(): HwDecTool(nullptr) { }
+    auto download(const MpImage &src) -> MpImage final { return src; }
+    auto downloadLuma(const MpImage &src, int step) -> const mp_image* final
+        { return m_luma.decimate(src.data(), step) ? m_luma.image() : nullptr; }
+    static auto isEnabled() -> bool
+        { static const bool on = qgetenv("BOMI_EMULATE_HWDEC") == "1"; return on; }
 };
 
 vf_info vf_info_noformat = create_vf_info();
@@ -91,6 +118,20 @@ struct VideoProcessor::Data {
     HwDecTool *hwdec = nullptr;
     mp_image_pool *pool = nullptr;
 
+    std::function<void(const mp_image*)> analyze;
+    FrameTimings *timings = nullptr;
+
+    auto filterStage() const -> FrameTimings::Stage
+    {
+        if (filter == &deinterlacer)
+            return FrameTimings::Deinterlacer;
+        if (filter == &interpolator)
+            return FrameTimings::Interpolator;
+        return FrameTimings::StageCount;
+    }
+    auto filterTimings() const -> FrameTimings*
+        { return filterStage() == FrameTimings::StageCount ? nullptr : timings; }
+
     QMutex mutex; // must be locked
     double ptsSkipStart = MP_NOPTS_VALUE, ptsLastSkip = MP_NOPTS_VALUE;
     bool skip = false;
@@ -128,6 +169,16 @@ VideoProcessor::~VideoProcessor()
     delete d;
 }
 
+auto VideoProcessor::setFrameAnalyzer(std::function<void(const mp_image*)> &&analyze) -> void
+{
+    d->analyze = std::move(analyze);
+}
+
+auto VideoProcessor::setFrameTimings(FrameTimings *timings) -> void
+{
+    d->timings = timings;
+}
+
 auto VideoProcessor::setMotionIntrplOption(const MotionIntrplOption &option) -> void
 {
     d->intrplOption = option;
@@ -163,7 +214,9 @@ auto VideoProcessor::open(vf_instance *vf) -> int
 
     _Delete(d->hwdec);
     hwdec_request_api(vf->hwdec, OS::hwAcc()->name().toLatin1());
-    if (vf->hwdec && vf->hwdec->hwctx)
+    if (SoftwareHwDecTool::isEnabled())
+        d->hwdec = new SoftwareHwDecTool;
+    else if (vf->hwdec && vf->hwdec->hwctx)
         d->hwdec = new HwDecTool(vf->hwdec->hwctx);
     mp_image_pool_clear(d->pool);
     p->vp->stopSkipping();
@@ -267,58 +320,6 @@ auto VideoProcessor::isSkipping() const -> bool
     return d->skip;
 }
 
-template<class F>
-static auto avgLuma(const mp_image *mpi, F &&addLine) -> double
-{
-    const uchar *const data = mpi->planes[0];
-    double avg = 0;
-    for (int y = 0; y < mpi->h; ++y)
-         addLine(avg, data + y * mpi->stride[0], mpi->w);
-    const int bits = mpi->fmt.plane_bits;
-    avg /= mpi->h * mpi->w;
-    avg /= (1 << bits) - 1;
-    if (mpi->params.colorlevels == MP_CSP_LEVELS_TV)
-        avg = (avg - 16.0/255)*255.0/(235.0 - 16.0);
-    return avg;
-}
-
-template<class T>
-static auto lumaYCbCrPlanar(const mp_image *mpi) -> double
-{
-    return avgLuma(mpi, [] (double &sum, const uchar *data, int w) {
-        const T *p = (const T*)data;
-        for (int x = 0; x < w; ++x)
-            sum += *p++;
-    });
-}
-
-static auto luminance(const mp_image *mpi) -> double
-{
-    switch (mpi->imgfmt) {
-    case IMGFMT_420P:   case IMGFMT_NV12:   case IMGFMT_NV21:
-    case IMGFMT_444P:   case IMGFMT_422P:   case IMGFMT_440P:
-    case IMGFMT_411P:   case IMGFMT_410P:   case IMGFMT_Y8:
-    case IMGFMT_444AP:  case IMGFMT_422AP:  case IMGFMT_420AP:
-        return lumaYCbCrPlanar<quint8>(mpi);
-    case IMGFMT_444P16: case IMGFMT_444P14: case IMGFMT_444P12:
-    case IMGFMT_444P10: case IMGFMT_444P9:  case IMGFMT_422P16:
-    case IMGFMT_422P14: case IMGFMT_422P12: case IMGFMT_422P10:
-    case IMGFMT_422P9:  case IMGFMT_420P16: case IMGFMT_420P14:
-    case IMGFMT_420P12: case IMGFMT_420P10: case IMGFMT_420P9:
-    case IMGFMT_Y16:
-        return lumaYCbCrPlanar<quint16>(mpi);
-    case IMGFMT_YUYV:   case IMGFMT_UYVY: {
-        const int offset = mpi->imgfmt == IMGFMT_UYVY;
-        return avgLuma(mpi, [&] (double &sum, const uchar *p, int w) {
-            p += offset;
-            for (int i = 0; i < w; ++i, p += 2)
-                sum += *p;
-        });
-    } default:
-        return -1;
-    }
-}
-
 auto VideoProcessor::hwdec() const -> QString
 {
     switch (d->hwdecType) {
@@ -339,6 +340,7 @@ auto VideoProcessor::hwdec() const -> QString
 
 auto VideoProcessor::filterIn(mp_image *_mpi) -> int
 {
+    FrameTimings::Scope scope(d->timings, FrameTimings::FilterIn);
     if (!_mpi) { // propagate eof
         d->passthrough.push(MpImage());
         d->deinterlacer.push(MpImage());
@@ -354,6 +356,8 @@ auto VideoProcessor::filterIn(mp_image *_mpi) -> int
         emit hwdecChanged(hwdec());
 
     MpImage mpi = MpImage::wrap(_mpi);
+    if (d->analyze && !IMGFMT_IS_HWACCEL(mpi->imgfmt))
+        d->analyze(mpi.data());
     if (d->skip) {
         d->mutex.lock();
         auto scan = d->skip;
@@ -372,17 +376,19 @@ auto VideoProcessor::filterIn(mp_image *_mpi) -> int
                     if (mpi->pts - start > 5*60)// 5min
                         return false;
                 }
-                MpImage img;
-                if (IMGFMT_IS_HWACCEL(mpi->imgfmt)) {
+                double y = -1.0;
+                if (IMGFMT_IS_HWACCEL(mpi->imgfmt) || SoftwareHwDecTool::isEnabled()) {
                     Q_ASSERT(d->hwdec);
                     if (!d->hwdec)
                         return false;
-                    img = d->hwdec->download(mpi);
+                    const int step = FrameStatistics::autoStep(mpi->h);
+                    auto luma = d->hwdec->downloadLuma(mpi, step);
+                    if (!luma)
+                        return false;
+                    y = FrameStatistics::compute(luma, 1, false).luma;
                 } else
-                    img = mpi;
-                if (img.isNull())
-                    return false;
-                const auto y = luminance(img.data());
+                    y = FrameStatistics::compute(mpi.data(),
+                                                 FrameStatistics::AutoStep, false).luma;
                 if (y < 0.005)
                     return false;
                 return true;
@@ -411,6 +417,7 @@ auto VideoProcessor::filterIn(mp_image *_mpi) -> int
     }
     if (_Change(d->inter_i, mpi.isInterlaced()))
         emit inputInterlacedChanged();
+    FrameTimings::Scope filter(d->filterTimings(), d->filterStage());
     d->filter->push(std::move(mpi));
     return 0;
 }
@@ -422,9 +429,14 @@ auto VideoProcessor::needsInput() const -> bool
 
 auto VideoProcessor::filterOut() -> int
 {
+    FrameTimings::Scope scope(d->timings, FrameTimings::FilterOut);
     if (!d->filter)
         return 0;
-    auto mpi = std::move(d->filter->pop());
+    MpImage mpi;
+    {
+        FrameTimings::Scope filter(d->filterTimings(), d->filterStage());
+        mpi = std::move(d->filter->pop());
+    }
     if (mpi.isNull())
         return 0;
     if (_Change(d->inter_o, d->deinterlacer.pass() ? d->inter_i : false))
@@ -3,7 +3,7 @@
 
 struct vf_instance;                     struct mp_image_params;
 struct vf_info;                         struct mp_image;
-struct MotionIntrplOption;
+struct MotionIntrplOption;             class FrameTimings;
 enum class DeintMethod;                 enum class ColorSpace;
 enum class ColorRange;
 
@@ -21,6 +21,9 @@ public:
     auto isSkipping() const -> bool;
     auto hwdec() const -> QString;
     auto setMotionIntrplOption(const MotionIntrplOption &option) -> void;
+    auto setFrameTimings(FrameTimings *timings) -> void;
+    // called in filter thread for every software-decoded input frame
+    auto setFrameAnalyzer(std::function<void(const mp_image*)> &&analyze) -> void;
     auto inputColorSpace() const -> ColorSpace;
     auto inputColorRange() const -> ColorRange;
     auto outputColorSpace() const -> ColorSpace;
@@ -1,9 +1,11 @@
 #include "videorenderer.hpp"
 #include "letterboxitem.hpp"
 #include "mpvosdrenderer.hpp"
+#include "frametimings.hpp"
 #include "opengl/opengltexture2d.hpp"
 #include "opengl/openglframebufferobject.hpp"
 #include "opengl/opengltexturebinder.hpp"
+#include "opengl/openglbenchmarker.hpp"
 #include "misc/dataevent.hpp"
 #include "misc/log.hpp"
 #include "enum/rotation.hpp"
@@ -123,6 +125,34 @@ private:
     bool m_osd = false;
 };
 
+// frame has been drawn on window before scene, so only depth is written
+// in order that items behind the frame are culled by depth test
+struct VideoRenderer::DepthShaderIface : public VideoRenderer::ShaderIface {
+    DepthShaderIface() {
+        vertexShader = R"(
+            uniform mat4 qt_Matrix;
+            attribute vec4 aPosition;
+            attribute vec2 aFrameTexCoord;
+            attribute vec2 aOsdTexCoord;
+            void main() {
+                gl_Position = qt_Matrix * aPosition;
+            }
+        )";
+        fragmentShader = R"(
+            void main() {
+                gl_FragColor = vec4(0.0);
+            }
+        )";
+        attributes << "aPosition" << "aFrameTexCoord" << "aOsdTexCoord";
+    }
+    void resolve(QOpenGLShaderProgram *) override { }
+    void update(QOpenGLShaderProgram *, VideoRenderer::ShaderData *) override { }
+    void beforeUpdate() override
+        { func()->glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE); }
+    void afterUpdate() override
+        { func()->glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE); }
+};
+
 struct VideoRenderer::Node : public QSGGeometryNode {
     Node(VideoRenderer *r): r(r) { setFlag(UsePreprocess, true); }
     auto preprocess() -> void final
@@ -136,6 +166,7 @@ private:
 
 struct VideoRenderer::Data {
     VideoRenderer *p = nullptr;
+    FrameTimings *timings = nullptr;
     double crop = -1.0, aspect = -1.0, dar = 0.0;
     bool onLetterbox = true, redraw = false, portrait = false;
     bool flip_h = false, flip_v = false, scaler = false;
@@ -151,6 +182,29 @@ struct VideoRenderer::Data {
     QSize sourceSize{0, 1};
     QTimer sizeChecker;
     RenderFrameFunc render = nullptr;
+    RenderDirectFunc renderDirect = nullptr;
+    bool directEnabled = true;
+    // direct is decided in sync phase, newFrame is for render thread
+    bool direct = false, newFrame = false;
+    // measures GPU time of whole scene to compare both paths
+    OpenGLBenchmarker *benchmarker = nullptr;
+
+    auto canRenderDirect() const -> bool
+    {
+        static const bool disabled = qgetenv("BOMI_NO_DIRECT_RENDERING") == "1";
+        auto w = p->window();
+        if (disabled || !directEnabled || !renderDirect || !w || !p->hasFrame())
+            return false;
+        if (osd.visible || flip_h || flip_v || !offset.isNull()
+                || rotation != Rotation::D0)
+            return false;
+        if (!p->isVisible() || p->opacity() < 1.0)
+            return false;
+        // frame has to fill the item and the item has to fill the window
+        const auto rect = p->boundingRect().toRect();
+        return vtx.toRect() == rect && p->mapRectToScene(rect).toRect()
+                == QRect(QPoint(0, 0), w->size());
+    }
 
     static auto isSameRatio(double r1, double r2) -> bool
         {return (r1 < 0.0 && r2 < 0.0) || qFuzzyCompare(r1, r2);}
@@ -244,6 +298,14 @@ VideoRenderer::VideoRenderer(QQuickItem *parent)
     setAcceptHoverEvents(true);
     setAcceptedMouseButtons(Qt::AllButtons);
     setFlag(ItemAcceptsDrops, true);
+    connect(this, &QQuickItem::windowChanged, [this] (QQuickWindow *window) {
+        if (!window)
+            return;
+        connect(window, &QQuickWindow::beforeRendering,
+                this, &VideoRenderer::renderDirect, Qt::DirectConnection);
+        connect(window, &QQuickWindow::afterRendering, this, [this] ()
+            { if (d->benchmarker) d->benchmarker->end(); }, Qt::DirectConnection);
+    });
     connect(&d->sizeChecker, &QTimer::timeout, [this] () {
         if (_Change(d->frame.size, d->fboSizeHint()) |
                 _Change(d->osd.size, d->osdSizeHint())) {
@@ -277,6 +339,23 @@ auto VideoRenderer::setRenderFrameFunction(const RenderFrameFunc &func) -> void
     d->render = func;
 }
 
+auto VideoRenderer::setRenderDirectFunction(const RenderDirectFunc &func) -> void
+{
+    d->renderDirect = func;
+    reserve(UpdateMaterial);
+}
+
+auto VideoRenderer::setDirectRenderingEnabled(bool enabled) -> void
+{
+    if (_Change(d->directEnabled, enabled))
+        reserve(UpdateMaterial);
+}
+
+auto VideoRenderer::isDirectRendering() const -> bool
+{
+    return d->direct;
+}
+
 auto VideoRenderer::updateForNewFrame(const QSize &displaySize) -> void
 {
     _PostEvent(Qt::HighEventPriority, this, NewFrame, displaySize);
@@ -305,6 +384,8 @@ auto VideoRenderer::initializeGL() -> void
     const quint32 p = 0x0;
     d->frame.fallback.initialize(1, 1, OGL::BGRA, &p);
     d->osd.fallback = d->frame.fallback;
+    if (qgetenv("BOMI_BENCHMARK_RENDERING") == "1")
+        d->benchmarker = new OpenGLBenchmarker(true);
 }
 
 auto VideoRenderer::finalizeGL() -> void
@@ -312,6 +393,9 @@ auto VideoRenderer::finalizeGL() -> void
     Super::finalizeGL();
     d->frame.fallback.destroy();
     _Delete(d->frame.fbo);
+    if (d->benchmarker)
+        d->benchmarker->destroy();
+    _Delete(d->benchmarker);
 }
 
 auto VideoRenderer::customEvent(QEvent *event) -> void
@@ -452,6 +536,8 @@ auto VideoRenderer::updatePolish() -> void
         d->frame.rect.setRight(NORM(x, width()));
 #undef NORM
     }
+    // trivial composition may have been changed
+    reserve(UpdateMaterial, false);
     if (d->onLetterbox) {
         d->osd.rect = QRectF(0, 0, 1, 1);
         d->osd.margins.setTop(d->vtx.top());
@@ -474,7 +560,7 @@ auto VideoRenderer::updatePolish() -> void
 auto VideoRenderer::setFlipped(bool horizontal, bool vertical) -> void
 {
     if (_Change(d->flip_h, horizontal) | _Change(d->flip_v, vertical))
-        reserve(UpdateGeometry);
+        reserve(UpdateAll);
 }
 
 auto VideoRenderer::mapToVideo(const QPointF &pos) -> QPointF
@@ -491,12 +577,14 @@ auto VideoRenderer::geometryChanged(const QRectF &new_, const QRectF& old) -> vo
 
 auto VideoRenderer::type() const -> Type*
 {
-    static Type type[2];
-    return &type[d->osd.visible];
+    static Type type[3];
+    return &type[d->direct ? 2 : d->osd.visible];
 }
 
 auto VideoRenderer::createShader() const -> ShaderIface*
 {
+    if (d->direct)
+        return new DepthShaderIface;
     return new VideoShaderIface(d->osd.visible);
 }
 
@@ -513,23 +601,63 @@ auto VideoRenderer::createNode() const -> QSGGeometryNode*
     return new Node(const_cast<VideoRenderer*>(this));
 }
 
+auto VideoRenderer::renderDirect() -> void
+{
+    if (d->benchmarker)
+        d->benchmarker->begin();
+    auto w = window();
+    if (!d->direct || !w || !d->renderDirect)
+        return;
+    FrameTimings::Scope scope(d->newFrame ? d->timings : nullptr, FrameTimings::Render);
+    const auto target = w->renderTarget();
+    const GLuint fbo = target ? target->handle()
+                              : w->openglContext()->defaultFramebufferObject();
+    w->resetOpenGLState();
+    d->renderDirect(fbo, w->size() * w->devicePixelRatio(), d->newFrame);
+    w->resetOpenGLState();
+    if (d->newFrame && d->timings)
+        d->timings->rendered();
+    d->newFrame = false;
+}
+
 auto VideoRenderer::render(VideoShaderData *data) -> void
 {
-    if (!data->redraw)
+    if (!data->redraw || d->direct)
         return;
     data->redraw = false;
     auto w = window();
     if (w && d->render) {
+        FrameTimings::Scope scope(d->timings, FrameTimings::Render);
         w->resetOpenGLState();
         d->render(d->frame.fbo, data->osdVisible ? d->osd.fbo : nullptr, data->osdMargins);
         w->resetOpenGLState();
+        if (d->timings)
+            d->timings->rendered();
     }
 }
 
+auto VideoRenderer::setFrameTimings(FrameTimings *timings) -> void
+{
+    d->timings = timings;
+}
+
 auto VideoRenderer::updateData(ShaderData *_data) -> void
 {
     auto data = static_cast<VideoShaderData*>(_data);
-    if (!d->redraw) {
+    if (_Change(d->direct, d->canRenderDirect())) {
+        // window has to be kept since frame is drawn before scene
+        window()->setClearBeforeRendering(!d->direct);
+        if (d->benchmarker)
+            d->benchmarker->reset();
+        _Info("Render video %%.", d->direct ? "directly on window" : "through FBO");
+        // FBO has not been updated while rendering directly
+        if (!d->direct)
+            d->redraw = true;
+    }
+    if (d->direct) {
+        d->newFrame |= d->redraw;
+        d->redraw = false;
+    } else if (!d->redraw) {
         _Trace("VideoRendererItem::updateTexture(): no queued frame");
     } else if (!d->frame.size.isEmpty()) {
         d->redraw = false;
@@ -7,8 +7,11 @@
 #include <functional>
 
 class OpenGLFramebufferObject;          enum class Rotation;
+class FrameTimings;
 using Fbo = OpenGLFramebufferObject;
 using RenderFrameFunc = std::function<void(Fbo*,Fbo*,const QMargins&)>;
+// renders into framebuffer of window; bool is true for new frame
+using RenderDirectFunc = std::function<void(GLuint,const QSize&,bool)>;
 
 struct VideoFrameOsdVertex {
     OGL::CoordAttr position, frameTexCoord, osdTexCoord;
@@ -53,6 +56,12 @@ public:
     auto setCropRatio(double ratio) -> void;
     auto setRotation(Rotation r) -> void;
     auto setRenderFrameFunction(const RenderFrameFunc &func) -> void;
+    // frame is drawn directly on window if nothing has to be composed with it
+    auto setRenderDirectFunction(const RenderDirectFunc &func) -> void;
+    auto setDirectRenderingEnabled(bool enabled) -> void;
+    auto isDirectRendering() const -> bool;
+    // render time and vsync intervals are recorded in render thread
+    auto setFrameTimings(FrameTimings *timings) -> void;
     auto updateForNewFrame(const QSize &displaySize) -> void;
     auto setFramebufferObjectFormat(OGL::TextureFormat format) -> void;
     auto framebufferObjectFormat() const -> OGL::TextureFormat;
@@ -85,9 +94,11 @@ private:
     auto customEvent(QEvent *event) -> void final;
     struct VideoShaderData;
     struct VideoShaderIface;
+    struct DepthShaderIface;
     struct Node;
 
     auto render(VideoShaderData *data) -> void;
+    auto renderDirect() -> void;
 
     struct Data;
     Data *d;